@@ -0,0 +1,100 @@
+/**
+ * MQTT Inbox Check
+ *
+ * Checks that every command of a MQTT message is parsed, even when the first one is answered
+ * right away. Like in PubSubClient, the received message and the published response share the same
+ * buffer ('packet'), so the commands after the first must be copied (MessageQueue) before it is dispatched.
+ *
+ * No broker is used: the message is given to MessageQueue::parse, as MQTT connections do after mqtt.loop(),
+ * and each response is written over 'packet'.
+ *
+ * NOTE: MQTT_INBOX (config.h) is 0 on small boards, use a board like ESP8266 or Mega.
+ *
+ * Expected result: "Received: 1 2 3" and "PASS"
+ */
+
+#include <OpenDevice.h>
+#include <utility/MessageQueue.h>
+
+const char MESSAGE[] = "/20/1/0\r/20/2/0\r/20/3/0\r"; // three PING commands
+
+uint8_t packet[64]; // PubSubClient buffer
+
+/**
+ * Stream that writes the responses over 'packet', like a publish.
+ */
+class PublishStream : public Stream {
+public:
+	PublishStream() : length(0), responses(0) {}
+
+	int available() { return 0; }
+	int peek() { return -1; }
+	int read() { return -1; }
+	int availableForWrite() { return sizeof(packet); }
+	void flush() {}
+
+	size_t write(uint8_t b) {
+		if (b == Command::ACK_BIT) { // end of message
+			responses++;
+			length = 0;
+		} else if (length < sizeof(packet)) {
+			packet[length++] = b;
+		}
+		return 1;
+	}
+
+	uint16_t length;
+	uint16_t responses;
+
+	using Print::write;
+};
+
+PublishStream publisher;
+DeviceConnection conn(publisher);
+MessageQueue inbox;
+
+uint8_t received[4];
+uint8_t receivedCount = 0;
+
+// Answer each command as soon as it is parsed (like DISCOVERY_REQUEST or a parse error)
+void onCommand(Command cmd) {
+	if (receivedCount < sizeof(received)) received[receivedCount++] = cmd.id;
+
+	Command response;
+	response.type = CommandType::PING_RESPONSE;
+	response.id = cmd.id;
+	response.deviceID = 0;
+	response.value = ResponseStatus::SUCCESS;
+	conn.send(response, true);
+}
+
+void setup() {
+	Serial.begin(115200);
+
+	conn.setDefaultListener(onCommand);
+
+	memcpy(packet, MESSAGE, strlen(MESSAGE));
+
+	const uint8_t *message = packet;
+	for (int pass = 0; pass < 10; ++pass) { // one command per loop pass
+		bool ok = inbox.parse(conn, message, (message ? strlen(MESSAGE) : 0));
+		message = NULL;
+		if (ok) conn.flush();
+	}
+	conn.drainTx();
+
+	Serial.print("Received:");
+	for (uint8_t i = 0; i < receivedCount; ++i) {
+		Serial.print(" ");
+		Serial.print(received[i]);
+	}
+	Serial.println();
+	Serial.print("Responses: "); Serial.println(publisher.responses);
+	Serial.print("Dropped: "); Serial.println(inbox.dropped);
+
+	bool pass = (receivedCount == 3 && received[0] == 1 && received[1] == 2 && received[2] == 3);
+	Serial.println(pass ? "PASS" : "FAIL");
+}
+
+void loop() {
+}
@@ -0,0 +1,190 @@
+/**
+ * Parser Benchmark
+ *
+ * Replays a recorded command stream through DeviceConnection (parser only) and
+ * through OpenDevice (parser + dispatch), using an in-memory Stream instead of a
+ * real link, and reports commands/sec, bytes/sec and cycles per command (time in us on boards
+ * without a cycle counter, like AVR, where micros() has a resolution of 4us).
+ * The cost of a command is the sum of all checkDataAvalible() calls until it is complete.
+ * It also decodes an IR raw-timing array with the bulk decoder (readIntValues) and
+ * with one readInt() per value, set ENABLE_SWAR_DECODER (config.h) to compare the digit paths.
+ *
+ * Use it to get a baseline before flashing any parser or dispatch change:
+ * run it before and after on the same board and compare the numbers.
+ *
+ * NOTE: Nothing is sent to a server, responses are only counted.
+ * NOTE: The parser part also runs on a PC (same stream, no dispatch): make -C tests bench
+ *
+ * @date 16/10/2026
+ */
+
+#include <OpenDevice.h>
+
+#define ROUNDS 50
+
+#if defined(ESP8266) || defined(ESP32)
+	#define CYCLES() ESP.getCycleCount()
+	#define CYCLES_UNIT "cycles"
+#else
+	#define CYCLES() micros()
+	#define CYCLES_UNIT "us"
+#endif
+
+// Recorded stream: ON_OFF, ANALOG, PING, USER_COMMAND, unknown device
+const char RECORDED[] PROGMEM =
+  "/1/1/1/1\r"
+  "/1/2/1/0\r"
+  "/2/3/2/128\r"
+  "/2/4/2/255\r"
+  "/20/5/0\r"
+  "/99/6/bench/3\r"
+  "/1/7/99/1\r";
+
+// IR raw timings (NEC), same list format used by IRDevice
+const char IR_RAW[] PROGMEM =
+  "/99/8/ir/[8950,4450,600,550,600,1650,600,550,600,1650,600,1650,600,550,600,1650,600,39500]\r";
+
+#define IR_VALUES 18
+
+/**
+ * Stream that replays a PROGMEM buffer and discards (but counts) everything written.
+ */
+class ReplayStream : public Stream {
+public:
+	ReplayStream(const char *data) : data(data), len(strlen_P(data)), pos(0), rx(0), tx(0) {}
+
+	int available() { return len - pos; }
+	int peek() { return (pos < len ? pgm_read_byte(data + pos) : -1); }
+	int read() {
+		if (pos >= len) return -1;
+		rx++;
+		return pgm_read_byte(data + pos++);
+	}
+	size_t write(uint8_t b) { tx++; return 1; }
+	void flush() {}
+
+	void rewind() { pos = 0; }
+
+	const char *data;
+	size_t len;
+	size_t pos;
+	unsigned long rx;
+	unsigned long tx;
+
+	using Print::write;
+};
+
+ReplayStream replay(RECORDED);
+DeviceConnection conn(replay);
+
+ReplayStream irReplay(IR_RAW);
+DeviceConnection irConn(irReplay);
+
+void benchCommand(){
+	// registered only to exercise USER_COMMAND dispatch
+}
+
+void report(const char *title, unsigned long commands, unsigned long bytes, unsigned long elapsed,
+		uint32_t cycles, uint32_t minCycles, uint32_t maxCycles){
+	Serial.print(title);
+	Serial.print(" :: cmds: "); Serial.print(commands);
+	Serial.print(" || cmds/s: "); Serial.print((commands * 1000000.0) / elapsed);
+	Serial.print(" || bytes/s: "); Serial.print((bytes * 1000000.0) / elapsed);
+	Serial.print(" || " CYCLES_UNIT "/cmd: "); Serial.print(cycles / commands);
+	Serial.print(" (min: "); Serial.print(minCycles);
+	Serial.print(", max: "); Serial.print(maxCycles);
+	Serial.println(")");
+}
+
+void bench(const char *title, bool dispatch){
+	unsigned long commands = 0;
+	uint32_t cycles = 0, minCycles = 0xFFFFFFFF, maxCycles = 0;
+	uint32_t spent = 0; // by current command, until it is complete
+
+	replay.rx = 0;
+	replay.tx = 0;
+
+	unsigned long start = micros();
+
+	for (int i = 0; i < ROUNDS; ++i) {
+		replay.rewind();
+		while (replay.available()) {
+			uint32_t begin = CYCLES();
+
+			bool received = conn.checkDataAvalible();
+			if (received) {
+				if (dispatch && ODev.messageReceived) ODev.onMessageReceivedImpl();
+				conn.flush();
+			}
+
+			spent += CYCLES() - begin;
+
+			if (received) {
+				commands++;
+				cycles += spent;
+				if (spent < minCycles) minCycles = spent;
+				if (spent > maxCycles) maxCycles = spent;
+				spent = 0;
+			}
+		}
+	}
+
+	unsigned long elapsed = micros() - start;
+
+	report(title, commands, replay.rx, elapsed, cycles, minCycles, maxCycles);
+	Serial.print("TX bytes: "); Serial.println(replay.tx);
+}
+
+void benchArray(const char *title, bool bulk){
+	int values[IR_VALUES];
+	uint32_t cycles = 0, minCycles = 0xFFFFFFFF, maxCycles = 0;
+
+	unsigned long start = micros();
+
+	for (int i = 0; i < ROUNDS; ++i) {
+		irReplay.rewind();
+		irConn.checkDataAvalible();
+		irConn.readSlice(); // skip command name
+
+		uint32_t begin = CYCLES();
+
+		if (bulk) {
+			irConn.readIntValues(values, IR_VALUES);
+		} else {
+			for (int v = 0; v < IR_VALUES; ++v) values[v] = irConn.readInt();
+		}
+
+		uint32_t spent = CYCLES() - begin;
+		cycles += spent;
+		if (spent < minCycles) minCycles = spent;
+		if (spent > maxCycles) maxCycles = spent;
+
+		irConn.flush();
+	}
+
+	unsigned long elapsed = micros() - start;
+
+	report(title, ROUNDS, ROUNDS * irReplay.len, elapsed, cycles, minCycles, maxCycles);
+	Serial.print("Check: "); Serial.print(values[0]); Serial.print(" .. "); Serial.println(values[IR_VALUES - 1]);
+}
+
+void setup() {
+	Serial.begin(115200);
+
+	ODev.name("ODevBench");
+	ODev.addDevice("LED", 13, Device::DIGITAL, false, 1);
+	ODev.addDevice("PWM", 9, Device::ANALOG, false, 2);
+	ODev.addCommand("bench", benchCommand);
+
+	bench("Parser", false);   // DeviceConnection only (no listener yet)
+
+	ODev.begin(conn);
+
+	bench("Dispatch", true);  // DeviceConnection + OpenDeviceClass
+
+	benchArray("Array (readIntValues)", true);
+	benchArray("Array (readInt)", false);
+}
+
+void loop() {
+}
@@ -0,0 +1,139 @@
+/**
+ * StateLog Simulator
+ *
+ * Compares the EEPROM wear of two ways to save device state:
+ *  - Fixed: whole configuration saved at the same address on each change (as in previous versions)
+ *  - StateLog: each change appended to the wear-leveled ring (ConfigClass::saveState)
+ *
+ * The storage is simulated in RAM (nothing is written in EEPROM) and each write of a cell is counted.
+ * The lifetime is estimated from the most written cell (AVR EEPROM: ~100.000 cycles).
+ * At the end the state is recovered from the simulated storage, like after a reboot.
+ *
+ * NOTE: Change STATE_LOG_SIZE (config.h) to see the effect of the log size.
+ * NOTE: Uses about 2KB of RAM (simulated memory and counters), use a board like ESP8266 or Mega.
+ *
+ * @date 16/10/2026
+ */
+
+#include <OpenDevice.h>
+#include <utility/StateLog.h>
+
+#define SAVES 10000          // changes of state
+#define DEVICES 4            // ANALOG devices (2 bytes of packed state each, after bits of DIGITAL devices)
+#define CELL_CYCLES 100000UL // endurance of EEPROM cells
+
+#define STATE_OFFSET(device) ((MAX_DEVICE + 7) / 8 + device * 2)
+
+#define CONFIG_SIZE sizeof(ConfigClass)
+#define MEMORY_SIZE (CONFIG_SIZE + STATE_LOG_SIZE)
+
+uint8_t memory[MEMORY_SIZE];
+uint16_t writes[MEMORY_SIZE];
+
+// Only bytes that changed are written (like ConfigClass::save and StateLog)
+void writeCell(uint16_t address, uint8_t value) {
+	if (memory[address] != value) {
+		memory[address] = value;
+		writes[address]++;
+	}
+}
+
+void writeConfig(ConfigClass &config) {
+	const uint8_t *data = (const uint8_t *) &config;
+	for (uint16_t i = 0; i < CONFIG_SIZE; i++) writeCell(i, data[i]);
+}
+
+/** StateLog using simulated memory, after configuration */
+class SimulatedLog : public StateLog {
+public:
+	SimulatedLog() : StateLog(CONFIG_SIZE, STATE_LOG_SIZE) {}
+protected:
+	uint8_t read(uint16_t address) { return memory[address]; }
+	void write(uint16_t address, uint8_t value) { writeCell(address, value); }
+};
+
+ConfigClass config;
+
+void reset() {
+	memset(memory, 0xFF, sizeof(memory)); // erased
+	memset(writes, 0, sizeof(writes));
+	memcpy(&config, &Config, sizeof(ConfigClass));
+	memset(config.devicesState, 0, sizeof(config.devicesState));
+	writeConfig(config);
+}
+
+void report(const char* title, unsigned long time) {
+	uint16_t maxWrites = 0;
+	uint32_t total = 0;
+	for (uint16_t i = 0; i < MEMORY_SIZE; i++) {
+		total += writes[i];
+		if (writes[i] > maxWrites) maxWrites = writes[i];
+	}
+
+	Serial.print(title);
+	Serial.print(" :: bytes written: "); Serial.print(total);
+	Serial.print(" || max writes of cell: "); Serial.print(maxWrites);
+	Serial.print(" || lifetime (saves): "); Serial.print((uint32_t) ((float) CELL_CYCLES * SAVES / maxWrites));
+	Serial.print(" || time(ms): "); Serial.println(time);
+}
+
+void simulateFixed() {
+	reset();
+	randomSeed(1);
+
+	unsigned long start = millis();
+	for (uint16_t i = 0; i < SAVES; i++) {
+		uint8_t device = random(DEVICES);
+		uint16_t value = random(1024);
+		memcpy(config.devicesState + STATE_OFFSET(device), &value, 2);
+		writeConfig(config);
+	}
+
+	report("Fixed", millis() - start);
+}
+
+void simulateLog() {
+	reset();
+	randomSeed(1);
+
+	SimulatedLog log;
+	log.load(NULL, 0);
+
+	unsigned long start = millis();
+	for (uint16_t i = 0; i < SAVES; i++) {
+		uint8_t device = random(DEVICES);
+		uint16_t value = random(1024);
+		memcpy(config.devicesState + STATE_OFFSET(device), &value, 2);
+
+		if (!log.append(STATE_OFFSET(device), config.devicesState + STATE_OFFSET(device), 2)) {
+			Serial.println("Ring is too small for devices");
+			return;
+		}
+	}
+
+	report("StateLog", millis() - start);
+
+	Serial.print("Records in ring: "); Serial.println(log.capacity());
+
+	// Reboot: load configuration and last changes from log
+	ConfigClass loaded;
+	memcpy(&loaded, memory, sizeof(ConfigClass));
+	SimulatedLog recovered;
+	recovered.load(loaded.devicesState, sizeof(loaded.devicesState));
+
+	bool ok = memcmp(loaded.devicesState, config.devicesState, sizeof(config.devicesState)) == 0;
+	Serial.print("Recovered state: "); Serial.println(ok ? "OK" : "FAIL");
+}
+
+void setup() {
+	Serial.begin(115200);
+	delay(1000);
+
+	Serial.print("Simulating "); Serial.print(SAVES); Serial.println(" saves of device state...");
+
+	simulateFixed();
+	simulateLog();
+}
+
+void loop() {
+}
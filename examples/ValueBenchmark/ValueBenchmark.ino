@@ -0,0 +1,157 @@
+/**
+ * Value Benchmark
+ *
+ * Measures the sensor-change path with the value_t selected by VALUE_TYPE (config.h or build flag -DVALUE_TYPE=...):
+ *  - Compare: read a sample, compare with currentValue and store it (Device::hasChanged)
+ *  - Send: ANALOG value command written by DeviceConnection (text protocol)
+ *  - Scale: conversion of a raw reading, like a sensor calibration (value * 5 / 1023)
+ * Build and run it once for each VALUE_DOUBLE, VALUE_FLOAT, VALUE_INT32 and VALUE_FIXED and compare the cycles.
+ *
+ * NOTE: Nothing is sent to a server, bytes are only counted.
+ *
+ * @date 16/10/2026
+ */
+
+#include <OpenDevice.h>
+
+#define ROUNDS 2000
+#define SAMPLES 16
+
+#if defined(ESP8266)
+	#define CYCLES() ESP.getCycleCount()
+#else
+	#define CYCLES() (micros() * (F_CPU / 1000000L))
+#endif
+
+// Readings of an analog sensor (with repeated values)
+const int16_t READINGS[SAMPLES] = { 512, 512, 515, 520, 520, 530, 1023, 1023, 0, 3, 3, 250, 251, 251, 700, 512 };
+
+/**
+ * Sensor that replays READINGS instead of reading a pin
+ */
+class ReplaySensor : public Device {
+public:
+	ReplaySensor() : Device(0, Device::ANALOG, true), next(0) {}
+
+	bool hasChanged() {
+		value_t value = READINGS[next++ % SAMPLES];
+		if (value != currentValue) {
+			currentValue = value;
+			return true;
+		}
+		return false;
+	}
+
+	uint16_t next;
+};
+
+/**
+ * Stream that discards (but counts) everything written.
+ */
+class NullStream : public Stream {
+public:
+	NullStream() : tx(0) {}
+
+	int available() { return 0; }
+	int peek() { return -1; }
+	int read() { return -1; }
+	int availableForWrite() { return 64; }
+	size_t write(uint8_t b) { tx++; return 1; }
+	void flush() {}
+
+	unsigned long tx;
+
+	using Print::write;
+};
+
+ReplaySensor sensor;
+NullStream output;
+DeviceConnection conn(output);
+
+void report(const char *title, uint32_t cycles, uint32_t minCycles, uint32_t maxCycles){
+	Serial.print(title);
+	Serial.print(" :: cycles/op: "); Serial.print(cycles / ROUNDS);
+	Serial.print(" (min: "); Serial.print(minCycles);
+	Serial.print(", max: "); Serial.print(maxCycles);
+	Serial.println(")");
+}
+
+#define MEASURE(spent) \
+	cycles += spent; \
+	if (spent < minCycles) minCycles = spent; \
+	if (spent > maxCycles) maxCycles = spent;
+
+void benchCompare(){
+	uint32_t cycles = 0, minCycles = 0xFFFFFFFF, maxCycles = 0;
+	uint16_t changes = 0;
+
+	for (int i = 0; i < ROUNDS; ++i) {
+		uint32_t begin = CYCLES();
+		if (sensor.hasChanged()) changes++;
+		uint32_t spent = CYCLES() - begin;
+		MEASURE(spent);
+	}
+
+	report("Compare", cycles, minCycles, maxCycles);
+	Serial.print("Changes: "); Serial.println(changes);
+}
+
+void benchSend(){
+	uint32_t cycles = 0, minCycles = 0xFFFFFFFF, maxCycles = 0;
+	Command cmd;
+	cmd.type = CommandType::ANALOG;
+	cmd.id = 0;
+	cmd.deviceID = 1;
+
+	output.tx = 0;
+
+	for (int i = 0; i < ROUNDS; ++i) {
+		sensor.hasChanged();
+		cmd.value = sensor.currentValue;
+
+		uint32_t begin = CYCLES();
+		conn.send(cmd);
+		uint32_t spent = CYCLES() - begin;
+		MEASURE(spent);
+	}
+
+	report("Send", cycles, minCycles, maxCycles);
+	Serial.print("TX bytes: "); Serial.println(output.tx);
+}
+
+void benchScale(){
+	uint32_t cycles = 0, minCycles = 0xFFFFFFFF, maxCycles = 0;
+	value_t total = 0;
+
+	for (int i = 0; i < ROUNDS; ++i) {
+		value_t reading = READINGS[i % SAMPLES];
+
+		uint32_t begin = CYCLES();
+		value_t volts = reading * 5 / 1023;
+		uint32_t spent = CYCLES() - begin;
+		MEASURE(spent);
+
+		total += volts;
+	}
+
+	report("Scale", cycles, minCycles, maxCycles);
+	Serial.print("Check: "); printValue(Serial, total); Serial.println();
+}
+
+void setup() {
+	Serial.begin(115200);
+
+	conn.txRoomKnown = true; // NullStream tells its free space
+
+	ODev.name("ODevBench");
+
+	Serial.print("VALUE_TYPE: "); Serial.print(VALUE_TYPE);
+	Serial.print(" || sizeof(value_t): "); Serial.println(sizeof(value_t));
+
+	benchCompare();
+	benchSend();
+	benchScale();
+}
+
+void loop() {
+}
@@ -25,6 +25,7 @@ namespace CommandType {
 		GPIO_DIGITAL 			= 4, // Commands sent directly to the pins (digitalWrite)
 		GPIO_ANALOG 			= 5, //  Commands sent directly to the pins (analogWrite)
 		INFRA_RED 				= 6,
+		BATCH_VALUES 			= 7, // Values of several devices in one frame: /7/id/0/length/deviceID/value/.../deviceID/value
 
 		DEVICE_COMMAND_RESPONSE = 10, // Response to commands like: ON_OFF, POWER_LEVEL, INFRA RED
 		COMMAND_RESPONSE 		= 11, // TODO: not implemented
@@ -36,10 +37,12 @@ namespace CommandType {
 		PING_RESPONSE           = 21,
 		DISCOVERY_REQUEST       = 22,
 		DISCOVERY_RESPONSE      = 23,
-		MEMORY_REPORT           = 24, // Report the amount of memory = displays the current and maximum).
-		CPU_TEMPERATURE_REPORT  = 25,
-		CPU_USAGE_REPORT        = 26,
+		MEMORY_REPORT           = 24, // Report memory: /24/id/free/largestBlock/fragmentation(%)/minFreeStack
+		CPU_TEMPERATURE_REPORT  = 25, // Report internal temperature: /25/id/celsius
+		CPU_USAGE_REPORT        = 26, // Report load: /26/id/usage(%)/loops(s)/rxBytes/txBytes/rxErrors/rxOverflows/txDropped/txStalls
 		RESET 		        			= 27, // Reset Microcontroller
+		FRAME_FORMAT            = 28, // Select framing used by connection to send commands (value: FrameFormat)
+		LOOP_PROFILE_REPORT     = 29, // Report loop time of each stage: /29/id/index/length/[name,count,min,avg,max,p99] (value 1: reset after report)
 
 		// ---
 		GET_DEVICES 			= 30,
@@ -65,6 +68,19 @@ namespace CommandType {
 	};
 }
 
+/**
+ * BINARY applies only to commands written with DeviceConnection::send(Command) (values, responses to
+ * device commands). Responses written as text (doStart/print/doEnd), like GET_DEVICES_RESPONSE, reports
+ * and debug messages, are always ASCII, so both formats are mixed on the same link:
+ * a frame starts with FRAME_BIT and a text command with START_BIT.
+ */
+namespace FrameFormat {
+	enum FrameFormat {
+		ASCII 	= 0, // /type/id/deviceID/value\r
+		BINARY 	= 1  // FRAME_BIT, length, type, id, deviceID, value, extra data, CRC8
+	};
+}
+
 namespace ResponseStatus {
 	enum ResponseStatus {
 		SUCCESS 			= 200,
@@ -86,6 +102,7 @@ struct Command {
 	static const uint8_t SEPARATOR = '/';
 	static const uint8_t ARRAY_SEPARATOR = ',';
 	static const uint8_t ACK_BIT = '\r';
+	static const uint8_t FRAME_BIT = 0xA5; // start of binary frame (see FrameFormat)
 
 	Command():type(0),id(0),deviceID(0),value(0),length(0){ }
 
@@ -102,6 +119,7 @@ struct Command {
 		switch (type) {
 		case CommandType::ON_OFF: return true;
 		case CommandType::ANALOG: return true;
+		case CommandType::BATCH_VALUES: return true; // deviceID is 0 and value is the length
 		default:
 			return false;
 		}
@@ -113,6 +131,8 @@ struct Command {
 		case CommandType::DISCOVERY_REQUEST: return true;
 		case CommandType::PING_REQUEST: return true;
 		case CommandType::PING_RESPONSE: return true;
+		case CommandType::FRAME_FORMAT: return true;
+		case CommandType::LOOP_PROFILE_REPORT: return true;
 		default:
 			return false;
 		}
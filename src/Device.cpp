@@ -58,6 +58,8 @@ void Device::_init(char* name, uint8_t _id, uint16_t _pin, DeviceType _type, boo
 	targetID = 0;
 	needSync = false;
 	inverted = false;
+	sendPolicy = COALESCE;
+	batchValues = false;
 	interruptEnabled = false;
 	interruptMode = CHANGE;
 	changeListener = 0;
@@ -92,7 +94,7 @@ bool Device::setValue(value_t value, bool sync){
 
 			_digitalWrite(pin, (value == 0 ? LOW : HIGH));
 		}else{
-			_analogWrite(pin, value);
+			_analogWrite(pin, (int) value);
 		}
 
 		notifyListeners(); // Notify internal listeners (onChange)
@@ -303,10 +305,6 @@ bool Device::notifyListeners(){
 // [ID, PIN, VALUE, TARGET, SENSOR?, TYPE]
 int Device::toString(Print* conn){
 
-	char v_str[6];
-	/* 4 is mininum width, 2 is precision; float value is copied onto str_temp*/
-	dtostrf(getValue(), 4, 2, v_str);
-
 	conn->print('[');
 
 	#if(ENABLE_PREFIX_NAME)
@@ -322,7 +320,7 @@ int Device::toString(Print* conn){
 	conn->print(',');
 	conn->print(pin);
 	conn->print(',');
-	conn->print(v_str);
+	printValue(*conn, getValue(), decimals(type));
 	conn->print(',');
 	conn->print(targetID);
 	conn->print(',');
@@ -62,6 +62,9 @@ public:
 	virtual void digitalWriteEx(uint16_t pin, uint8_t val){};
 
 	virtual void loop(){};
+
+	/** Pin of the board that signals changes of extender pins (used by Device::enableInterrupt), -1 if none */
+	virtual int16_t interruptPin(){ return -1; };
 };
 
 /**
@@ -105,6 +108,23 @@ public:
 		}
 	}
 
+	/** Decimal places of values sent as text */
+	static uint8_t decimals( DeviceType type ) {
+		switch (type) {
+		case Device::FLOAT2: return 2;
+		case Device::FLOAT2_SIGNED: return 2;
+		case Device::FLOAT4: return 4;
+		default:
+			return 0;
+		}
+	}
+
+	/** What to do with a value change when the connection's send queue is full (see TX_QUEUE) */
+	enum SendPolicy{
+		COALESCE = 0, // keep it pending, latest value is sent when there is room
+		DROP = 1      // discard it (counted in DeviceConnection::txDropped)
+	};
+
   // NOTE: On change this, my need change: OpenDeviceClass::onSensorChanged
 
 	const static uint8_t MAX_ANALOG_VALUE = 255;
@@ -125,6 +145,14 @@ public:
 
 	bool inverted; // It allows to operate in an inverted logic (activeLow)
 
+	SendPolicy sendPolicy;
+
+	/**
+	 * Sensor changes can be sent with other changes in a single BATCH_VALUES frame, which has no extra data (serializeExtraData).
+	 * Set by OpenDeviceClass::addDevice for the devices it creates, changes of other devices are sent as they happen.
+	 */
+	bool batchValues;
+
 	// for interrupt mode
 	volatile bool needSync;
 	bool interruptEnabled; // only for sensor
@@ -200,6 +228,8 @@ public:
 
 	Device* setIOExtender(IOExtender* _extender);
 
+	IOExtender* getIOExtender() { return ioExtender; }
+
 	bool notifyListeners();
 
 	int toString(Print* conn);
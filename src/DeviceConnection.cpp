@@ -23,6 +23,15 @@ extern "C" {
 	#include <stdlib.h>
 }
 
+// CRC-8 (polynomial 0x07) of binary frames
+static uint8_t crc8(uint8_t crc, uint8_t data){
+	crc ^= data;
+	for (uint8_t i = 0; i < 8; ++i) {
+		crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+	}
+	return crc;
+}
+
 // public methods
 DeviceConnection::DeviceConnection(){
 	init();
@@ -50,7 +59,22 @@ void DeviceConnection::init(){
 	defaultListener = NULL;
 	_buffer_overflow = false;
 	_endOffset = 0;
-
+	_readOffset = 0;
+
+	resetDecoder();
+
+	_format = FrameFormat::ASCII;
+	_binary = false;
+	_rxSkip = 0;
+	_framing = false;
+	_frameOverflow = false;
+	_frameStart = 0;
+	_corked = 0;
+	_txLength = 0;
+	#if TX_QUEUE > 0
+	_txQueueHead = 0;
+	_txQueueLength = 0;
+	#endif
 
 //	for(int a = 0;a < MAX_LISTENERS;a++){
 //		listeners[a] = NULL;
@@ -107,46 +131,9 @@ bool DeviceConnection::checkDataAvalible(){
 			lastByte = conn->read();
 			available--;
 
-			#if DEBUG_CON
-				Serial.print(F("DB:READ:"));Serial.println((char)lastByte);
-			#endif
-
-			// NOTE: Start bit is equals to the SEPARATOR
-			if(lastByte == START_BIT && !processing){
-				processing = true;
-				//digitalWrite(11,HIGH);
-				//digitalWrite(10,HIGH);
-				continue;
-			}
-			else if(lastByte == ACK_BIT){
-
-				#if DEBUG_CON
-					Serial.println(F("DB:END_CMD"));
-				#endif
-
-				processing = false;
-
-				uint8_t type = parseInt();
-				// digitalWrite(11,LOW);
-				parseCommand(type);
-
-
-				return true;
-
-			}else if(processing){
-
-				uint8_t w = store(lastByte);
-				// digitalWrite(10, !digitalRead(10));
-
-				if(!w){
-					notifyError(ResponseStatus::BUFFER_OVERFLOW);
-					#if DEBUG_CON
-					Serial.println(F("DB:BUFFER_OVERFLOW"));
-					#endif
-					return false;
-				}
-
-			}
+			uint8_t result = receive(lastByte);
+			if(result == RECEIVED) return true;
+			if(result == RECEIVE_FAILED) return false;
 		}
 
 		// // Wait a bit to read the next byte if not available yet.
@@ -163,6 +150,93 @@ bool DeviceConnection::checkDataAvalible(){
 	return !timeout;
 }
 
+/**
+ * Parse received data that is already in memory (like a MQTT payload), without reading it through a Stream.
+ * Stops at the end of the first command. Returns the bytes used, 'received' tells if a command was parsed.
+ */
+uint16_t DeviceConnection::parse(const uint8_t *data, uint16_t length, bool &received){
+
+	received = false;
+
+	for (uint16_t i = 0; i < length; i++) {
+		uint8_t result = receive(data[i]);
+		if(result == RECEIVED) received = true;
+		if(result != RECEIVING) return i + 1;
+	}
+
+	return length;
+}
+
+/** Handle next received byte, returns RECEIVING, RECEIVED (command parsed) or RECEIVE_FAILED */
+uint8_t DeviceConnection::receive(uint8_t lastByte){
+
+	rxBytes++;
+
+	#if DEBUG_CON
+		Serial.print(F("DB:READ:"));Serial.println((char)lastByte);
+	#endif
+
+	// Rest of a rejected binary frame, must not be taken as text commands
+	if(_rxSkip > 0){
+		_rxSkip--;
+		return RECEIVING;
+	}
+
+	// Binary frame is length-prefixed, so ACK_BIT and START_BIT are plain data here
+	if(_binary){
+		return receiveFrame(lastByte) ? RECEIVED : RECEIVING;
+	}
+
+	if(lastByte == Command::FRAME_BIT && !processing){
+		processing = true;
+		_binary = true;
+		_rxLength = 0;
+		_endOffset = 0;
+		_readOffset = 0;
+		resetDecoder();
+		return RECEIVING;
+	}
+
+	// NOTE: Start bit is equals to the SEPARATOR
+	if(lastByte == START_BIT && !processing){
+		processing = true;
+		resetDecoder();
+		//digitalWrite(11,HIGH);
+		//digitalWrite(10,HIGH);
+	}
+	else if(lastByte == ACK_BIT){
+
+		#if DEBUG_CON
+			Serial.println(F("DB:END_CMD"));
+		#endif
+
+		processing = false;
+
+		// digitalWrite(11,LOW);
+		parseCommand();
+
+		return RECEIVED;
+
+	}else if(processing){
+
+		uint8_t w = store(lastByte);
+		// digitalWrite(10, !digitalRead(10));
+
+		if(w){
+			decode(lastByte);
+		}else{
+			notifyError(ResponseStatus::BUFFER_OVERFLOW);
+			#if DEBUG_CON
+			Serial.println(F("DB:BUFFER_OVERFLOW"));
+			#endif
+			return RECEIVE_FAILED;
+		}
+
+	}
+
+	return RECEIVING;
+}
+
 
 // Private methods
 void DeviceConnection::notifyListeners(Command cmd){
@@ -180,6 +254,9 @@ void DeviceConnection::notifyListeners(Command cmd){
 
 
 void DeviceConnection::notifyError(ResponseStatus::ResponseStatus status){
+	if(status == ResponseStatus::BUFFER_OVERFLOW) rxOverflows++;
+	else rxErrors++;
+
 	Command cmd;
 	cmd.type = CommandType::DEVICE_COMMAND_RESPONSE;
 	cmd.deviceID = 0;
@@ -188,32 +265,190 @@ void DeviceConnection::notifyError(ResponseStatus::ResponseStatus status){
 	send(cmd, true);
 }
 
-void DeviceConnection::parseCommand(uint8_t type){
+void DeviceConnection::resetDecoder(){
+	cmd.type = 0;
+	cmd.id = 0;
+	cmd.deviceID = 0;
+	cmd.value = 0;
+	_field = 0;
+	_fields = 1; // only type, until it is known
+	_inNumber = false;
+	_negative = false;
+	_number = 0;
+	_headerEnd = _endOffset;
+}
+
+/**
+ * Decode header fields as bytes are stored, so nothing is scanned again on ACK_BIT.
+ * Same rules of parseInt(): leading non-digits are skipped and a field ends on the first
+ * non-digit, which is kept in the buffer as the start of the extra data.
+ */
+void DeviceConnection::decode(uint8_t c){
 
-	cmd.type = type;
-	cmd.id = readInt();
+	if(_field >= _fields) return; // header complete, the rest is extra data
 
-	if(Command::isDeviceCommand(type)){
-		cmd.deviceID = readInt();
-		cmd.value = readLong();
-	}else if(Command::isSimpleCommand(type)){
-		cmd.value = readLong();
-		cmd.deviceID = 0;
-	}else{
-		cmd.deviceID = 0;
-		cmd.value = 0;
+	if(c >= '0' && c <= '9'){
+		_number = _number * 10 + c - '0';
+		_inNumber = true;
+		return;
+	}
+
+	if(_inNumber){
+		endField(_endOffset - 1);
+		if(_field >= _fields) return;
+	}
+
+	if(c == '-'){
+		_negative = true;
+		_inNumber = true;
+	}
+}
+
+void DeviceConnection::endField(uint16_t offset){
+
+	long value = (_negative ? -_number : _number);
+
+	switch (_field) {
+	case 0:
+		cmd.type = value;
+		if(Command::isDeviceCommand(cmd.type)) _fields = 4;      // type/id/deviceID/value
+		else if(Command::isSimpleCommand(cmd.type)) _fields = 3; // type/id/value
+		else _fields = 2;                                        // type/id
+		break;
+	case 1:
+		cmd.id = value;
+		break;
+	case 2:
+		if(_fields == 4) cmd.deviceID = value;
+		else cmd.value = value;
+		break;
+	case 3:
+		cmd.value = value;
+		break;
 	}
 
+	_field++;
+	_number = 0;
+	_negative = false;
+	_inNumber = false;
+	_headerEnd = offset;
+}
+
+void DeviceConnection::parseCommand(){
+
+	if(_inNumber) endField(_endOffset); // last field ended by ACK_BIT
+
+	// Extra data starts after the header, if header is incomplete there is nothing left
+	_readOffset = (_field >= _fields ? _headerEnd : _endOffset);
+
 	#if DEBUG_CON || DEBUG_ON_PC
 		Serial.print("DB:CMD:");
 		Serial.print(cmd.type);Serial.print(";");
 		Serial.print(cmd.id);Serial.print(";");
 		Serial.print(cmd.deviceID);Serial.print(";");
-		Serial.print(cmd.value);Serial.print("");
+		printValue(Serial, cmd.value);Serial.print("");
+		Serial.write(ACK_BIT);
+	#endif
+
+	onMessageReceived(cmd);
+}
+
+/**
+ * Receive next byte of binary frame: FRAME_BIT, length, [type, id, deviceID, value, extra data], CRC8.
+ * Returns true when a valid frame was parsed.
+ */
+bool DeviceConnection::receiveFrame(uint8_t byte){
+
+	if(_rxLength == 0){ // length
+		if(byte == 0 || byte > _len){ // larger only if DATA_BUFFER < 255
+			_binary = false;
+			processing = false;
+			_rxSkip = byte + 1; // data and CRC
+			notifyError(ResponseStatus::BUFFER_OVERFLOW);
+			return false;
+		}
+		_rxLength = byte;
+		_rxCRC = crc8(0, byte);
+		return false;
+	}
+
+	if(_endOffset < _rxLength){
+		store(byte);
+		_rxCRC = crc8(_rxCRC, byte);
+		return false;
+	}
+
+	_binary = false;
+	processing = false;
+
+	if(byte != _rxCRC){
+		flush();
+		notifyError(ResponseStatus::BAD_REQUEST);
+		return false;
+	}
+
+	if(!parseFrame()){
+		flush();
+		notifyError(ResponseStatus::BAD_REQUEST);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Header of binary frame is: type, id, deviceID (1 byte each) and value.
+ * ANALOG values are a float (4 bytes, little-endian), others a zigzag varint.
+ * Return false if the header is incomplete or the value is invalid (truncated, or varint longer than 32 bits).
+ */
+bool DeviceConnection::parseFrame(){
+
+	if(_endOffset < 3) return false;
+
+	cmd.type = _buffer[0];
+	cmd.id = _buffer[1];
+	cmd.deviceID = _buffer[2];
+
+	uint16_t offset = 3;
+
+	if(cmd.type == CommandType::ANALOG){
+		if(_endOffset < offset + sizeof(float)) return false;
+		float value;
+		memcpy(&value, &_buffer[offset], sizeof(float));
+		cmd.value = value;
+		offset += sizeof(float);
+	}else{
+		unsigned long v = 0;
+		uint8_t shift = 0;
+		bool complete = false;
+		while(offset < _endOffset && !complete){
+			if(shift >= 32) return false;
+			uint8_t b = _buffer[offset++];
+			v |= (unsigned long)(b & 0x7F) << shift;
+			shift += 7;
+			complete = !(b & 0x80);
+		}
+		if(!complete) return false;
+		cmd.value = (long)(v >> 1) ^ -(long)(v & 1);
+	}
+
+	_readOffset = (offset < _endOffset ? offset : _endOffset);
+
+	#if DEBUG_CON
+		Serial.print("DB:FRAME:");
+		Serial.print(cmd.type);Serial.print(";");
+		Serial.print(cmd.id);Serial.print(";");
+		Serial.print(cmd.deviceID);Serial.print(";");
+		printValue(Serial, cmd.value);
 		Serial.write(ACK_BIT);
 	#endif
 
 	onMessageReceived(cmd);
+	return true;
+}
+
+bool DeviceConnection::acceptFrameFormat(uint8_t format){
+	return format == FrameFormat::ASCII || format == FrameFormat::BINARY;
 }
 
 void DeviceConnection::onMessageReceived(Command cmd) {
@@ -228,26 +463,168 @@ void DeviceConnection::getBuffer(uint8_t buf[]){
 }
 
 void DeviceConnection::printBuffer(){
-	Serial.println((const char *)_buffer);
+	Serial.write(_buffer, _endOffset);
+	Serial.println();
 }
 
 
 #if defined(ARDUINO) && ARDUINO >= 100
 size_t DeviceConnection::write(uint8_t b){
 	if(!conn || !connected || processing) return 0;
-	return conn->write(b);
+	return put(b);
 }
 #else
 void DeviceConnection::write(uint8_t b){
 	if(!conn || !connected || processing) return;
-	conn->write(b);
+	put(b);
+}
+#endif
+
+/** Digits are formatted with ValueUtils and written through write(), so connections that override it still get them */
+void DeviceConnection::writeNumber(long number){
+	char text[VALUE_TEXT_SIZE];
+	write((const uint8_t *) text, formatNumber(text, number));
+}
+
+void DeviceConnection::writeValue(value_t value, uint8_t decimals){
+	char text[VALUE_TEXT_SIZE];
+	uint8_t length = formatValue(text, value, decimals);
+	if(length) write((const uint8_t *) text, length);
+	else printValue(*this, value, decimals); // large values
+}
+
+/** Append to output buffer, making room if it is full */
+bool DeviceConnection::put(uint8_t b){
+	if(_txLength >= TX_BUFFER && !spill()){
+		_frameOverflow = true;
+		return false;
+	}
+	_tx[_txLength++] = b;
+	return true;
+}
+
+/**
+ * Write what can be written of a full output buffer.
+ * ASCII commands can be written in parts, an open binary frame must stay in the
+ * buffer (length is only known at the end), so only the commands before it are written.
+ */
+bool DeviceConnection::spill(){
+	if(!_framing){
+		flushTx();
+		return true;
+	}
+
+	if(_frameStart == 0) return false;
+
+	writeTx(_tx, _frameStart);
+	txBytes += _frameStart;
+	_txLength -= _frameStart;
+	memmove(_tx, _tx + _frameStart, _txLength);
+	_frameStart = 0;
+	return _txLength < TX_BUFFER;
+}
+
+/**
+ * Default transport write: commands go to the send queue (when enabled) and are written
+ * by drainTx(), so a slow stream doesn't stall the loop. If the queue is full, waits for
+ * the transport (counted in txStalls).
+ * Streams that can't tell their free space (txRoomKnown) get the commands at once, as without queue.
+ */
+void DeviceConnection::writeTx(const uint8_t *data, uint16_t length){
+#if TX_QUEUE > 0
+	if(!txRoomKnown){
+		drainTx();
+		conn->write(data, length);
+		return;
+	}
+
+	if(_txQueueLength + length > TX_QUEUE){
+		txStalls++;
+		while(_txQueueLength > 0){
+			uint16_t chunk = TX_QUEUE - _txQueueHead;
+			if(chunk > _txQueueLength) chunk = _txQueueLength;
+			conn->write(&_txQueue[_txQueueHead], chunk);
+			_txQueueHead = (_txQueueHead + chunk) % TX_QUEUE;
+			_txQueueLength -= chunk;
+		}
+		_txQueueHead = 0;
+		if(length > TX_QUEUE){
+			conn->write(data, length);
+			return;
+		}
+	}
+	enqueueTx(data, length);
+	drainTx();
+#else
+	conn->write(data, length);
+#endif
 }
+
+#if TX_QUEUE > 0
+void DeviceConnection::enqueueTx(const uint8_t *data, uint16_t length){
+	uint16_t tail = (_txQueueHead + _txQueueLength) % TX_QUEUE;
+	for (uint16_t i = 0; i < length; ++i) {
+		_txQueue[tail] = data[i];
+		tail = (tail + 1) % TX_QUEUE;
+	}
+	_txQueueLength += length;
+}
+#endif
+
+void DeviceConnection::drainTx(){
+#if TX_QUEUE > 0
+	if(_txQueueLength == 0 || !conn) return;
+
+	int room = _txQueueLength; // stream does not report free space, write all (see writeTx)
+	if(txRoomKnown){
+		room = conn->availableForWrite();
+		if(room <= 0) return; // full, try again in next loop pass
+	}
+
+	while(_txQueueLength > 0 && room > 0){
+		uint16_t chunk = TX_QUEUE - _txQueueHead;
+		if(chunk > _txQueueLength) chunk = _txQueueLength;
+		if(chunk > room) chunk = room;
+		conn->write(&_txQueue[_txQueueHead], chunk);
+		_txQueueHead = (_txQueueHead + chunk) % TX_QUEUE;
+		_txQueueLength -= chunk;
+		room -= chunk;
+	}
+
+	if(_txQueueLength == 0) _txQueueHead = 0;
+#endif
+}
+
+uint16_t DeviceConnection::txQueued(){
+#if TX_QUEUE > 0
+	return _txQueueLength;
+#else
+	return 0;
 #endif
+}
 
+uint16_t DeviceConnection::txFree(){
+#if TX_QUEUE > 0
+	return TX_QUEUE - _txQueueLength;
+#else
+	return 0xFFFF;
+#endif
+}
 
+void DeviceConnection::flushTx(){
+	if(_txLength == 0 || _framing) return;
+	if(conn) writeTx(_tx, _txLength);
+	txBytes += _txLength;
+	_txLength = 0;
+}
+
+void DeviceConnection::uncork(){
+	if(_corked > 0) _corked--;
+	if(_corked == 0) flushTx();
+}
 
 void DeviceConnection::doStart(){
-	flush();
+	clearRx();
 	write(START_BIT);
 }
 
@@ -256,125 +633,179 @@ void DeviceConnection::doToken(){ // FIXME: change name to putToken();
 }
 
 void DeviceConnection::doEnd(){ // FIXME: change name to putEnd();
-	write(ACK_BIT);
-	flush();
+	endCommand();
+	clearRx();
+}
+
+void DeviceConnection::beginFrame(){
+	_framing = true;
+	_frameOverflow = false;
+	_frameStart = _txLength;
+	write(Command::FRAME_BIT);
+	write((uint8_t) 0); // length, filled by endFrame
+}
+
+void DeviceConnection::endFrame(){
+	_framing = false;
+
+	uint16_t length = _txLength - _frameStart - 2;
+
+	// Truncated frame is dropped, receiver would read wrong extra data
+	if(_frameOverflow || _txLength < _frameStart + 2 || length == 0){
+		_txLength = _frameStart;
+		return;
+	}
+
+	_tx[_frameStart + 1] = length;
+
+	uint8_t crc = crc8(0, length);
+	for (uint16_t i = _frameStart + 2; i < _txLength; ++i) {
+		crc = crc8(crc, _tx[i]);
+	}
+
+	put(crc);
 }
 
 
 void DeviceConnection::send(char c ){
 	write(START_BIT);
 	write(c);
-	write(ACK_BIT);
+	endCommand();
 }
 
 void DeviceConnection::send(const char str[]){
 	if(!conn || !connected || processing) return;
 	write(START_BIT);
-	conn->write(str);
-	write(ACK_BIT);
+	write(str);
+	endCommand();
 }
 
 void DeviceConnection::send(long values[], int size){
 	if(!conn || !connected || processing) return;
-	conn->write(START_BIT);
-	char vbuffer[3];
+	write(START_BIT);
 	for (int i = 0; i < size; ++i) {
-		ltoa(values[i], vbuffer, 10);
-		conn->write(vbuffer);
-		conn->write(SEPARATOR);
+		print(values[i]);
+		write(SEPARATOR);
 	}
-	conn->write(ACK_BIT);
+	endCommand();
 }
 
 
 void DeviceConnection::send(int values[], int size){
 	if(!conn || !connected || processing) return;
-	conn->write(START_BIT);
-	char vbuffer[3]; // 3 digits
+	write(START_BIT);
 	for (int i = 0; i < size; ++i) {
-		itoa(values[i], vbuffer, 10);
-		conn->write(vbuffer);
-		conn->write(SEPARATOR);
+		print(values[i]);
+		write(SEPARATOR);
 	}
-	conn->write(ACK_BIT);
+	endCommand();
 }
 
 void DeviceConnection::send(uint8_t n){
 	if(!conn || !connected || processing) return;
-	conn->write(START_BIT);
-	conn->write(n);
-	conn->write(ACK_BIT);
+	write(START_BIT);
+	write(n);
+	endCommand();
 }
 void DeviceConnection::send(int n){
 	if(!conn || !connected || processing) return;
-	conn->write(START_BIT);
-	conn->print(n);
-	conn->write(ACK_BIT);
+	write(START_BIT);
+	print(n);
+	endCommand();
 }
 void DeviceConnection::send(unsigned int n){
 	if(!conn || !connected || processing) return;
-	conn->write(START_BIT);
-	conn->print(n);
-	conn->write(ACK_BIT);
+	write(START_BIT);
+	print(n);
+	endCommand();
 }
 void DeviceConnection::send(long n){
 	if(!conn || !connected || processing) return;
-	conn->write(START_BIT);
-	conn->print(n);
-	conn->write(ACK_BIT);
+	write(START_BIT);
+	print(n);
+	endCommand();
 }
 void DeviceConnection::send(unsigned long n){
 	if(!conn || !connected || processing) return;
-	conn->write(START_BIT);
-	conn->print(n);
-	conn->write(ACK_BIT);
+	write(START_BIT);
+	print(n);
+	endCommand();
 }
 
 void DeviceConnection::send(long n, int base){
 	if(!conn || !connected || processing) return;
-	conn->write(START_BIT);
-	conn->print(n, base);
-	conn->write(ACK_BIT);
+	write(START_BIT);
+	print(n, base);
+	endCommand();
 }
 void DeviceConnection::send(double n){
 	if(!conn || !connected || processing) return;
-	conn->write(START_BIT);
-	conn->print(n);
-	conn->write(ACK_BIT);
+	write(START_BIT);
+	print(n);
+	endCommand();
 }
 
-void DeviceConnection::send(Command cmd, bool complete){
+void DeviceConnection::send(Command cmd, bool complete, uint8_t decimals){
 	if(!conn || !connected || processing) return;
-    // digitalWrite(10, LOW);
-	unsigned long values[] = {cmd.type, cmd.id, cmd.deviceID};
 
-	conn->flush();
-
-	conn->write(START_BIT);
-	char vbuffer[3];
-	for (int i = 0; i < 3; ++i) {
-		utoa(values[i], vbuffer, 10);
-		conn->write(vbuffer);
-		conn->write(SEPARATOR);
+	if(_format == FrameFormat::BINARY){
+		beginFrame();
+		write(cmd.type);
+		write(cmd.id);
+		write(cmd.deviceID);
+		if(CommandType::ANALOG == cmd.type){
+			float value = (float) cmd.value;
+			write((const uint8_t *) &value, sizeof(float));
+		}else{
+			long n = (long) cmd.value;
+			unsigned long v = ((unsigned long) n << 1) ^ (unsigned long) -(n < 0); // zigzag
+			while(v >= 0x80){
+				write((uint8_t) (v | 0x80));
+				v >>= 7;
+			}
+			write((uint8_t) v);
+		}
+		if(complete) endCommand();
+		return;
 	}
 
+	write(START_BIT);
+	writeNumber(cmd.type);
+	write(SEPARATOR);
+	writeNumber(cmd.id);
+	write(SEPARATOR);
+	writeNumber(cmd.deviceID);
+	write(SEPARATOR);
+
 	if(CommandType::ANALOG == cmd.type)
-		conn->print(cmd.value);
+		writeValue(cmd.value, decimals);
 	else
-		conn->print((long)cmd.value);
+		writeNumber((long)cmd.value);
 
-	if(complete) conn->write(ACK_BIT);
-	else conn->write(SEPARATOR);
+	if(complete) endCommand();
+	else write(SEPARATOR);
 
 }
 
+/** Close current command (ACK_BIT or binary frame) and write it, unless output is corked */
+void DeviceConnection::endCommand(){
+	if(_framing) endFrame();
+	else write(ACK_BIT);
+	if(!_corked) flushTx();
+}
+
 
 void DeviceConnection::flush() {
-  memset(_buffer, 0, _len);
   if(conn) conn->flush();
+  clearRx();
+}
+
+/** Discard received command, without waiting for the transport like flush() */
+void DeviceConnection::clearRx() {
   _endOffset = 0;
   _readOffset = 0;
   _buffer_overflow = false;
+  resetDecoder();
 }
 
 
@@ -384,7 +815,7 @@ void DeviceConnection::flush() {
 
 size_t DeviceConnection::store(uint8_t byte) {
   _buffer_overflow = _endOffset >= _len;
-  _buffer[_endOffset++] = byte;
+  if(!_buffer_overflow) _buffer[_endOffset++] = byte;
   return !_buffer_overflow;
 }
 
@@ -408,55 +839,32 @@ int DeviceConnection::read(void){
 }
 
 int DeviceConnection::readLongValues(long values[], int max){
-	int size = 0;
-	memset(values, 0, max);
-	int lastOffset = _endOffset;
-	_endOffset = nextEndOffSet();
-
-	while(available() && size < max){
-		values[size] = parseInt();
-		size++;
-	}
-
-	_readOffset+=2;// skip separator '];'
-	_endOffset = lastOffset;
-
-	return size;
+	return readList().toArray(values, max);
 }
 
 int DeviceConnection::readIntValues(int values[], int max){
-	int size = 0;
-	memset(values, 0, max);
-	int lastOffset = _endOffset;
-	_endOffset = nextEndOffSet();
-
-	while(available() && size < max){
-		values[size] = parseInt();
-		size++;
-	}
-
-	_readOffset+=2; // skip separator '];'
-	_endOffset = lastOffset;
-
-	return size;
+	return readList().toArray(values, max);
 }
 
 int DeviceConnection::readFloatValues(float values[], int max)
 {
-	int size = 0;
-	memset(values, 0, max);
-	int lastOffset = _endOffset;
-	_endOffset = nextEndOffSet();
-
-	while(available() && size < max){
-		values[size] = parseFloat();
-		size++;
-	}
+	return readList().toArray(values, max);
+}
 
-	_readOffset+=2;// skip separator '];'
-	_endOffset = lastOffset;
+Slice DeviceConnection::readSlice()
+{
+	uint16_t offset = _readOffset;
+	Slice slice = Slice::token(_buffer, offset, _endOffset);
+	_readOffset = offset;
+	return slice;
+}
 
-	return size;
+Slice DeviceConnection::readList()
+{
+	uint16_t offset = _readOffset;
+	Slice slice = Slice::list(_buffer, offset, _endOffset);
+	_readOffset = offset;
+	return slice;
 }
 
 String DeviceConnection::readString()
@@ -474,6 +882,20 @@ String DeviceConnection::readString()
 	  return ret;
 }
 
+uint16_t DeviceConnection::hash(const char* str)
+{
+	  uint16_t hash = 0;
+	  while (*str) hash = hash * 31 + (uint8_t) *str++;
+	  return hash;
+}
+
+uint16_t DeviceConnection::hash(const Slice &token)
+{
+	  uint16_t hash = 0;
+	  for (uint16_t i = 0; i < token.length; i++) hash = hash * 31 + (uint8_t) token[i];
+	  return hash;
+}
+
 // returns the first valid (long) integer value from the current position.
 // initial characters that are not digits (or the minus sign) are skipped
 // function is terminated by the first character that is not a digit.
@@ -554,18 +976,3 @@ int DeviceConnection::peekNextDigit()
     read();  // discard non-numeric
   }
 }
-
-
-int DeviceConnection::nextEndOffSet(){
-	int endOffset = _readOffset;
-	for(int end = _readOffset;end < _endOffset;end++){
-		if (isListEnd(_buffer[end]) && end != _readOffset) break;
-		endOffset++;
-	}
-
-	return endOffset;
-}
-
-bool DeviceConnection::isListEnd(char c){
-	return  c==']' || c==')' || c=='}' || c==Command::SEPARATOR;
-}
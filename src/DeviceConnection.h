@@ -17,6 +17,8 @@
 #include <Arduino.h>
 #include "config.h"
 #include "Command.h"
+#include "utility/Slice.h"
+#include "utility/ValueUtils.h"
 
 extern "C"
 {
@@ -28,6 +30,7 @@ extern "C"
 * Definitions
 ******************************************************************************/
 
+
 /**
  * Implements the application level protocol of the OpenDevice.
  */
@@ -50,10 +53,46 @@ protected:
 	float parseFloat();               // float version of parseInt
 	int available();
 	size_t store(uint8_t byte);
-	void parseCommand(uint8_t type);
+	void decode(uint8_t byte);
+	void parseCommand();
+
+	/** Write buffered output (one or more complete commands) to the transport */
+	virtual void writeTx(const uint8_t *data, uint16_t length);
 private:
 	uint16_t readTimeout; // time in ms to the wait for end command
 
+	// Incremental decoding of the header (type/id/deviceID/value) while bytes arrive
+	uint8_t _field;      // index of the field being decoded
+	uint8_t _fields;     // fields expected for current type
+	bool _inNumber;
+	bool _negative;
+	long _number;
+	uint16_t _headerEnd; // offset of extra data in _buffer
+
+	// Binary framing (see FrameFormat)
+	uint8_t _format;        // format used to send commands
+	bool _binary;           // receiving a binary frame
+	uint8_t _rxLength;      // length of binary frame being received (0 = not known yet)
+	uint8_t _rxCRC;
+	uint16_t _rxSkip;       // bytes of a rejected binary frame still to be discarded
+	bool _framing;          // binary frame open in _tx (header is filled by endFrame)
+	bool _frameOverflow;
+	uint16_t _frameStart;   // offset of open binary frame in _tx
+
+	// Output buffer, commands are assembled here and written to 'conn' in a single call
+	uint8_t _corked;        // see cork()
+	uint16_t _txLength;
+	uint8_t _tx[TX_BUFFER];
+
+#if TX_QUEUE > 0
+	// Commands waiting for the transport (ring buffer), see drainTx()
+	uint8_t _txQueue[TX_QUEUE];
+	uint16_t _txQueueHead;
+	uint16_t _txQueueLength;
+
+	void enqueueTx(const uint8_t *data, uint16_t length);
+#endif
+
 	CommandListener defaultListener;  			// default listener
 //	CommandListener listeners[MAX_LISTENERS];   // user listeners
 //	uint8_t listeners_key[MAX_LISTENERS];       // listeners keys(CommandType).
@@ -65,6 +104,25 @@ private:
 
 	int getArrayLength();
 
+	void resetDecoder();
+	void clearRx();
+	void endField(uint16_t offset);
+
+	// Result of receive()
+	static const uint8_t RECEIVING = 0;
+	static const uint8_t RECEIVED = 1;
+	static const uint8_t RECEIVE_FAILED = 2;
+
+	uint8_t receive(uint8_t byte);
+	bool receiveFrame(uint8_t byte);
+	bool parseFrame();
+	void beginFrame();
+	void endFrame();
+
+	bool put(uint8_t byte);
+	bool spill();
+	void endCommand();
+
 
 	int peekNextDigit(); // returns the next numeric digit in the stream or -1 if timeout
 	const uint16_t current_length() const { return _endOffset; }
@@ -72,8 +130,6 @@ private:
     int peek();
     int read();
 
-    int nextEndOffSet();
-    bool isListEnd(char c);
 
 public:
 
@@ -88,6 +144,19 @@ public:
 
 	bool connected = true;
 	uint16_t reconnectionsCount = 0;
+	uint32_t rxBytes = 0;
+	uint32_t txBytes = 0;    // bytes handed to the transport
+	uint16_t rxErrors = 0;   // invalid commands/frames (BAD_REQUEST)
+	uint16_t rxOverflows = 0; // commands larger than DATA_BUFFER (BUFFER_OVERFLOW)
+	uint16_t txDropped = 0;  // value updates discarded because send queue was full (see Device::sendPolicy)
+	uint16_t txStalls = 0;   // times send queue was full and sending had to wait for the transport
+
+	/**
+	 * Stream implements availableForWrite (like HardwareSerial), so commands can be queued and drainTx writes only what fits.
+	 * Otherwise 0 can't be told from "not implemented": the send queue is not used and commands are written whole
+	 * (like to WiFiClient, EthernetClient or MQTTClient, which publishes each command as a message).
+	 */
+	bool txRoomKnown = false;
 
 	// public methods
 	DeviceConnection();
@@ -97,8 +166,38 @@ public:
 	virtual void disconnect(void);
 	void flush(void);
 	virtual bool checkDataAvalible(void);
+	uint16_t parse(const uint8_t *data, uint16_t length, bool &received);
 
 	void setStream(Stream *stream) { conn = stream; };
+
+	/**
+	 * Hold output until uncork(), so several commands (like GET_DEVICES responses) are
+	 * written to the transport together. Calls can be nested.
+	 */
+	void cork() { _corked++; }
+	void uncork();
+
+	/** Write buffered output to the transport now */
+	void flushTx();
+
+	/** Write queued output, as much as the transport accepts without blocking. Called on each loop */
+	void drainTx();
+
+	/** Bytes waiting in send queue */
+	uint16_t txQueued();
+
+	/** Free bytes in send queue (0xFFFF if there is no queue, sending is synchronous) */
+	uint16_t txFree();
+
+	/** Publish current value of a device in its state topic (see ENABLE_STATE_TOPICS). Return false to try again later */
+	virtual bool sendState(const char * /*name*/, value_t /*value*/, uint8_t /*decimals*/) { return true; }
+
+	/** Check if connection can send/receive using this FrameFormat */
+	virtual bool acceptFrameFormat(uint8_t format);
+
+	/** Select FrameFormat used to send commands. Received frames are detected automatically */
+	void setFrameFormat(uint8_t format) { _format = format; }
+	uint8_t frameFormat() { return _format; }
 	void setDefaultListener(CommandListener);
 //	void addListener(uint8_t,CommandListener);
 //	void removeListener(uint8_t);
@@ -106,6 +205,18 @@ public:
 	void printBuffer();
 
 	String readString();
+
+	/** Hash of a token (like a command name from readSlice), to compare it with known names */
+	static uint16_t hash(const char* str);
+	static uint16_t hash(const Slice &token);
+
+	/** Read next string token (like readString) as a view into the receive buffer */
+	Slice readSlice();
+
+	/** Read next list like: [1,2,3];  as a view of its values (1,2,3), use Slice::nextInt to decode them */
+	Slice readList();
+	/** Check if there is another number in extra data (skipping what is before it), like the next value of readInt */
+	bool hasNextNumber(){ return peekNextDigit() >= 0; }
 	inline int readInt(){ return parseInt(); }
 	inline long readLong(){ return parseInt(); }
 	inline float readFloat(){ return parseFloat(); }
@@ -141,7 +252,12 @@ public:
     void send(unsigned long);
     void send(long, int);
     void send(double);
-    void send(Command, bool complete = true);
+    /** Send command, ANALOG values (ASCII format) are written with 'decimals' (see Device::decimals) */
+    void send(Command, bool complete = true, uint8_t decimals = 2);
+
+    /** Write number / value as text (faster than print) */
+    void writeNumber(long number);
+    void writeValue(value_t value, uint8_t decimals = 2);
 
     template < class T > void sendCmdArg (T arg){
     	conn->write(START_BIT);
@@ -11,46 +11,173 @@
 
 namespace od {
 
-MQTTClient::MQTTClient(PubSubClient& mqtt, uint8_t * _buffer) : StreamBuffer(_buffer, DATA_BUFFER) {
+MQTTClient::MQTTClient(PubSubClient& mqtt, Client& client, uint8_t * _buffer) :
+		StreamBuffer(_buffer, DATA_BUFFER),
+		backoff(MQTT_RECONNECT_MIN, RECONNECT_TIMEOUT) {
 	this->mqtt = &mqtt;
+	this->client = &client;
+	port = 0;
+	sending = false;
+	connectAttempts = 0;
+	state = OFFLINE;
+	offlineSince = 0;
+	offlineTotal = 0;
 }
 
 MQTTClient::~MQTTClient() {
 }
 
-void MQTTClient::begin(){
-	topic = String(Config.appID);
-	topic += "/out/";
-	topic += Config.moduleName;
+// {appID}{middle}{moduleName}
+static void compose(char *topic, const char *middle){
+	strcpy(topic, Config.appID);
+	strcat(topic, middle);
+	strcat(topic, Config.moduleName);
 }
 
-void MQTTClient::setData(uint8_t *data, const uint16_t len){
-	flush();
-	for(uint32_t i = 0; i < len; i++) {
-		StreamBuffer::write(data[i]);
+void MQTTClient::begin(uint16_t port){
+	this->port = port;
+	mqtt->setServer(Config.server, port);
+
+#if defined(ESP8266)
+	client->setTimeout(MQTT_CONNECT_TIMEOUT); // WiFiClient uses it also in connect(), a broker down would stall the loop for seconds
+#endif
+
+	compose(clientID, "/");
+	compose(inTopic, "/in/");
+	compose(outTopic, "/out/");
+
+	// Devices that lost the broker together must not retry together
+	uint32_t hash = micros();
+	for (const char *c = clientID; *c; c++) hash = hash * 31 + *c;
+	backoff.seed(hash);
+	backoff.reset();
+
+#if(ENABLE_STATE_TOPICS)
+	compose(stateTopic, "/state/");
+	strcat(stateTopic, "/");
+	stateTopicLength = strlen(stateTopic);
+#endif
+}
+
+#if(ENABLE_STATE_TOPICS)
+bool MQTTClient::publishState(const char *name, value_t value, uint8_t decimals){
+	if(!mqtt->connected()) return false;
+
+	strncpy(stateTopic + stateTopicLength, name, sizeof(stateTopic) - stateTopicLength - 1);
+	stateTopic[sizeof(stateTopic) - 1] = 0;
+
+	char text[VALUE_TEXT_SIZE];
+	uint8_t length = formatValue(text, value, decimals);
+	if(!length) length = formatNumber(text, (long) value); // too large for decimals
+
+	return mqtt->publish(stateTopic, (const uint8_t *) text, length, true);
+}
+#endif
+
+bool MQTTClient::reconnect(){
+
+	if(mqtt->connected()){
+		if(state != ONLINE){
+			offlineTotal += millis() - offlineSince;
+			state = ONLINE;
+		}
+		return true;
 	}
-	#if DEBUG_CON
-	Serial.print("MQTT RECV: ");
-	Serial.println((const char *) StreamBuffer::_buffer);
-	#endif
+
+	if(state == ONLINE){ // connection lost
+		disconnected();
+		return false;
+	}
+
+	if(state == OFFLINE){
+		if(!backoff.ready()) return false;
+
+		connectAttempts++;
+		LOG_DEBUG("MQTT", "connecting... ");
+
+		// TCP connection now, MQTT handshake in next call (loop can read sensors between them)
+		if(client->connected() || client->connect(Config.server, port)){
+			state = HANDSHAKE;
+		}else{
+			backoff.fail();
+			LOG_DEBUG("MQTT <Fail TCP>", backoff.failures());
+		}
+		return false;
+	}
+
+	// HANDSHAKE
+	if(mqtt->connect(clientID, Config.appID, "*")){
+		LOG_DEBUG("MQTT", "[connected]");
+		mqtt->subscribe(inTopic);
+		offlineTotal += millis() - offlineSince;
+		state = ONLINE;
+		return true;
+	}
+
+	LOG_DEBUG("MQTT <Fail>", mqtt->state());
+	client->stop();
+	backoff.fail();
+	state = OFFLINE;
+	return false;
+}
+
+void MQTTClient::disconnected(){
+	if(state != ONLINE) return;
+	offlineSince = millis();
+	state = OFFLINE;
+	backoff.reset();
+}
+
+uint32_t MQTTClient::offlineTime(){
+	return offlineTotal + (state == ONLINE ? 0 : millis() - offlineSince);
 }
 
 // Write to buffer and wait for ACK to publish
 size_t MQTTClient::write(uint8_t v){
 	if(v == Command::ACK_BIT){ // don't write ACK
-		#if DEBUG_CON
-		Serial.print("MQTT SEND: ");
-		Serial.println((const char *) StreamBuffer::_buffer);
-		#endif
-		mqtt->publish(topic.c_str(), (const char *) StreamBuffer::_buffer);
-		flush();
+		publish(_buffer, current_length());
+		clear();
+		sending = false;
 		return 1;
 	}else{ // Write to buffer
+		// First byte of a message, discard received data that shares the buffer
+		if(!sending){
+			clear();
+			sending = true;
+		}
 		return StreamBuffer::write(v);
 	}
 
 }
 
+/** Commands that are complete in 'data' are published from there, parts of a command are kept in buffer */
+size_t MQTTClient::write(const uint8_t *data, size_t size){
+	const uint8_t *end = data + size;
+
+	while(data < end){
+		const uint8_t *ack = (const uint8_t *) memchr(data, Command::ACK_BIT, end - data);
+
+		if(ack && !sending){
+			publish(data, ack - data);
+			data = ack + 1;
+		}else{
+			const uint8_t *stop = (ack ? ack + 1 : end);
+			while(data < stop) write(*data++);
+		}
+	}
+
+	return size;
+}
+
+void MQTTClient::publish(const uint8_t *data, uint16_t length){
+	#if DEBUG_CON
+	Serial.print("MQTT SEND: ");
+	Serial.write(data, length);
+	Serial.println();
+	#endif
+	mqtt->publish(outTopic, data, length);
+}
+
 
 } /* namespace od */
 
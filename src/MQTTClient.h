@@ -13,24 +13,80 @@
 
 #include "config.h"
 #include "Command.h"
+#include "utility/ValueUtils.h"
 #include "utility/StreamBuffer.h"
+#include "utility/Backoff.h"
+#include "utility/Logger.h"
 
 
 namespace od {
 
+/** Room for a topic like {appID}/state/{moduleName} */
+#define MQTT_TOPIC_SIZE (sizeof(ConfigClass::appID) + sizeof(ConfigClass::moduleName) + 8)
+
+/**
+ * Stream used to publish commands of a DeviceConnection, each command is a message.
+ * Topics and client ID are composed once (begin), so publishing doesn't use the heap.
+ */
 class MQTTClient : public StreamBuffer {
 public:
-	MQTTClient(PubSubClient&, uint8_t * _buffer);
+	MQTTClient(PubSubClient&, Client&, uint8_t * _buffer);
 	virtual ~MQTTClient();
 
     virtual size_t write(uint8_t);
-    void setData(uint8_t *buffer, const uint16_t len);
-    void begin();
+    virtual size_t write(const uint8_t *data, size_t size);
+    void begin(uint16_t port);
 	bool connected(){ return mqtt->connected(); };
 
+	/**
+	 * Connect again if offline, call on each loop. Each call does one step (TCP connection, then MQTT handshake
+	 * in the next call) and attempts are spaced by 'backoff'. Return true if connected.
+	 * NOTE: Steps still block: the DNS lookup of Config.server, the TCP connection (limited to MQTT_CONNECT_TIMEOUT
+	 * only on ESP8266, other clients use their own timeout) and the wait for CONNACK (MQTT_SOCKET_TIMEOUT).
+	 */
+	bool reconnect();
+
+	/** Connection was lost outside of MQTT (like WiFi), offline time is counted from now */
+	void disconnected();
+
+	/** Time (ms) without MQTT connection, including current disconnection */
+	uint32_t offlineTime();
+
+	Backoff backoff;
+	uint16_t connectAttempts; // TCP connections opened to broker
+
+	char clientID[MQTT_TOPIC_SIZE];  // {appID}/{moduleName}
+	char inTopic[MQTT_TOPIC_SIZE];   // {appID}/in/{moduleName}, subscribed
+	char outTopic[MQTT_TOPIC_SIZE];  // {appID}/out/{moduleName}
+
+#if(ENABLE_STATE_TOPICS)
+	/** Publish value of device in {appID}/state/{moduleName}/{name} (retained) */
+	bool publishState(const char *name, value_t value, uint8_t decimals);
+#endif
+
+    /** Keep a message that is being written, the others are published with their length (no need to fill buffer with zeros) */
+    virtual void flush() { if(!sending) clear(); }
+
+    using Print::write;
+
 private:
     PubSubClient* mqtt;
-    String topic;
+    Client* client;
+    uint16_t port;
+    bool sending; // message being written to buffer (published on ACK_BIT)
+
+    // Steps of reconnect()
+    enum ConnectState { ONLINE, OFFLINE, HANDSHAKE };
+    uint8_t state;
+    unsigned long offlineSince;
+    uint32_t offlineTotal;      // ms offline, of past disconnections
+
+    void publish(const uint8_t *data, uint16_t length);
+
+#if(ENABLE_STATE_TOPICS)
+    char stateTopic[MQTT_TOPIC_SIZE + MAX_DEVICE_NAME]; // {appID}/state/{moduleName}/ and name of device
+    uint8_t stateTopicLength;                            // length without name
+#endif
 };
 
 } /* namespace od */
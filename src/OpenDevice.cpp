@@ -34,6 +34,17 @@ OpenDeviceClass::OpenDeviceClass() :
 	deviceLength = 0;
 	commandsLength = 0;
 	needSaveDevices = false;
+	pendingLength = 0;
+	sensorQueueLength = 0;
+	pollSensorsLength = 0;
+	memset((void*) pendingSensors, 0, sizeof(pendingSensors));
+	memset(interruptIndex, 0, sizeof(interruptIndex));
+#if(ENABLE_STATE_TOPICS)
+	memset(statesPublished, 0, sizeof(statesPublished));
+#endif
+	busyTime = 0;
+	busyLoops = 0;
+	usageStart = 0;
 
 	if(SAVE_DEVICE_INTERVAL == 0) saveAndDebugTimer.disable();
 
@@ -41,8 +52,12 @@ OpenDeviceClass::OpenDeviceClass() :
 		devices[i] = NULL;
 	}
 
+	memset(idIndex, 0, sizeof(idIndex));
+	memset(nameIndex, 0, sizeof(nameIndex));
+	memset(commandIndex, 0, sizeof(commandIndex));
+
 	#if defined(ESP8266)
-		EEPROM.begin(sizeof(Config));
+		EEPROM.begin(sizeof(Config) + STATE_LOG_SIZE);
 	#endif
 
 	load(); // Load storage configuration
@@ -81,6 +96,7 @@ void OpenDeviceClass::begin(HardwareSerial &serial, unsigned long baud){
 	serial.begin(baud);
 
 	DeviceConnection *conn =  new DeviceConnection(serial);
+	conn->txRoomKnown = true;
 	begin(*conn);
 
 }
@@ -91,6 +107,7 @@ void OpenDeviceClass::begin(Serial_ &serial, unsigned long baud){
 	serial.begin(baud);
 
 	DeviceConnection *conn =  new DeviceConnection(serial);
+	conn->txRoomKnown = true;
 	begin(*conn);
 }
 #endif
@@ -101,6 +118,7 @@ void OpenDeviceClass::begin(Serial_ &serial, unsigned long baud){
 	serial.begin(baud);
 
 	DeviceConnection *conn =  new DeviceConnection(serial);
+	conn->txRoomKnown = true;
 	begin(*conn);
 }
 #endif
@@ -145,17 +163,18 @@ void OpenDeviceClass::begin(DeviceConnection &_deviceConnection) {
 
 	for (int i = 0; i < deviceLength; i++) {
 		devices[i]->init();
-		if(devices[i]->interruptEnabled){
-			#if(ENABLE_DEVICE_INTERRUPTION)
-				PIN_INTERRUPT = &arduinoInterruptedPin;
-				enableInterrupt(devices[i]->pin, &(OpenDeviceClass::onInterruptReceived), devices[i]->interruptMode);
-			#endif
-		}
 	}
 
+	indexInterrupts();
+
 	// Load Device(ID) / Value from Storage and set in devices
 	loadDevicesFromStorage();
 
+	// IDs may have been changed in sketch or loaded from storage
+	indexDevices();
+
+	scheduleSensors();
+
 	// Trace restarts using VALUE of board
 	devices[0]->currentValue++;
 
@@ -167,6 +186,10 @@ void OpenDeviceClass::begin(DeviceConnection &_deviceConnection) {
 
 	_afterBegin();
 
+	// Start of stack high-water mark (MEMORY_REPORT) and CPU usage window
+	SystemStats::paintStack();
+	usageStart = micros();
+
 	// ODev.debug("Begin [OK]");
 
 }
@@ -176,9 +199,12 @@ void OpenDeviceClass::_loop() {
 
 	loops++;
 
+	PROFILE_MARK(mark);
+
 	if(deviceConnection){
 
 		deviceConnection->checkDataAvalible();
+		PROFILE(LoopStage::RECEIVE, mark);
 
 		// Send PING/KeepAlive if enabled
 		if(Config.keepAlive){
@@ -195,6 +221,7 @@ void OpenDeviceClass::_loop() {
 	}
 
 	checkSensorsStatus();
+	PROFILE(LoopStage::SENSORS, mark);
 
 	if(saveAndDebugTimer.expired()){
 
@@ -205,10 +232,15 @@ void OpenDeviceClass::_loop() {
 
 			Serial.print("= Uptime: "); Serial.print((millis() / 1000) / 60); Serial.print("min");
 			Serial.print(" || Loop(s): "); Serial.print(loops);
-			Serial.print(" || Restart(s): "); Serial.print(devices[0]->currentValue);
+			Serial.print(" || Restart(s): "); Serial.print((long) devices[0]->currentValue);
 			Serial.println();
 
 			Serial.print("= Connected: "); Serial.print(isConnected());
+			if(deviceConnection){
+				Serial.print(" || TX Queue: "); Serial.print(deviceConnection->txQueued());
+				Serial.print(" || Drops: "); Serial.print(deviceConnection->txDropped);
+				Serial.print(" || Stalls: "); Serial.print(deviceConnection->txStalls);
+			}
 
 			#if defined(ESP8266)
 				wl_status_t status = WiFi.status();
@@ -220,6 +252,14 @@ void OpenDeviceClass::_loop() {
 			#endif
 				Serial.println();
 
+			#if(ENABLE_LOOP_PROFILER)
+				Serial.println("= Stage: name,count,min,avg,max,p99 (us)");
+				for (uint8_t i = 0; i < LoopStage::COUNT; ++i) {
+					if(profiler.count(i) == 0) continue;
+					Serial.print("= "); profiler.print(i, Serial); Serial.println();
+				}
+			#endif
+
 			loops=0;
 
 			Logger.printLoop('=', 60);
@@ -229,15 +269,18 @@ void OpenDeviceClass::_loop() {
 		// Save
 		if(needSaveDevices){
 			unsigned long time = micros();
+			PROFILE_MARK(saveMark); // debug output of this block is not part of SAVE
 
+			// Only values that changed are written
 			for (int i = 0; i < deviceLength; ++i) {
-				Device *device = getDeviceAt(i);
-				Config.devicesState[i] = device->currentValue;
+				uint8_t offset, size;
+				if(packState(i, offset, size)) Config.saveState(offset, size);
 			}
 
-			save(); // TODO: improve saving only device state
+			Config.commit();
 			saveAndDebugTimer.reset();
 			needSaveDevices = false;
+			PROFILE(LoopStage::SAVE, saveMark);
 
 			Logger.debug("Saving devices, time(uS)", micros() - time);
 		}
@@ -283,20 +326,31 @@ void OpenDeviceClass::onMessageReceived(Command cmd) {
 	ODev.lastCMD = cmd;
 }
 
+/**
+ * Interrupt handler of sensors with enableInterrupt(). Only records the change (see SensorEventQueue),
+ * it's handled later by checkSensorsStatus() in loop().
+ */
 void OpenDeviceClass::onInterruptReceived(){
 
 //#ifdef EnableInterrupt_h
-    for (int i = 0; i < ODev.deviceLength; i++) {
-    	Device *device = ODev.getDeviceAt(i);
+	uint8_t pinChange = *(uint8_t *) PIN_INTERRUPT;
+	if(pinChange >= INTERRUPT_PINS) return;
 
-    	uint8_t pinChange = *(uint8_t *) PIN_INTERRUPT;
+	uint32_t now = millis();
 
-    	if(device->sensor && device->pin == pinChange){
-    		if(device->canReadSensor() && device->hasChanged()){
-    			device->needSync = true;
-    		}
-    	}
-    }
+	// Devices of this pin, see indexInterrupts()
+	for (uint8_t next = ODev.interruptIndex[pinChange]; next; next = ODev.interruptNext[next - 1]) {
+		uint8_t i = next - 1;
+		Device *device = ODev.devices[i];
+
+		// Level of digital pins is read now to keep each edge, others are read in loop
+		int8_t value = SENSOR_EVENT_UNREAD;
+		if(device->type == Device::DIGITAL && !device->getIOExtender()) value = digitalRead(device->pin);
+
+		if(!ODev.sensorEvents.push(i, value, now)){
+			ODev.pendingSensors[i >> 3] |= (1 << (i & 7)); // queue is full, read current state in loop
+		}
+	}
 //#endif
 
 }
@@ -325,6 +379,12 @@ void OpenDeviceClass::onSensorChanged(Device* sensor){
 		}
 	}
 
+	// Values without extra data are sent at the end of loop pass
+	if(sensor->batchValues){
+		queueValue(sensor);
+		return;
+	}
+
 	// SEND: Command
 	// ==========================
 	lastCMD.id = 0;
@@ -333,7 +393,7 @@ void OpenDeviceClass::onSensorChanged(Device* sensor){
 	lastCMD.value = sensor->currentValue;
 
 	if(deviceConnection->connected){
-		deviceConnection->send(lastCMD, false);
+		deviceConnection->send(lastCMD, false, Device::decimals(sensor->type));
 		// Check extra data to send.
 		sensor->serializeExtraData(deviceConnection);
 		deviceConnection->doEnd();
@@ -341,6 +401,93 @@ void OpenDeviceClass::onSensorChanged(Device* sensor){
 
 }
 
+void OpenDeviceClass::queueValue(Device* device){
+
+	if(device == NULL) return;
+
+	for (int p = 0; p < pendingLength; p++) {
+		if(pendingValues[p] == device) return; // already queued, current value will be sent
+	}
+
+	if(pendingLength < MAX_DEVICE) pendingValues[pendingLength++] = device;
+}
+
+/**
+ * Send values changed in this loop pass. A single change is sent as usual,
+ * several changes are sent in one BATCH_VALUES frame.
+ */
+void OpenDeviceClass::sendPendingValues(){
+
+	if(pendingLength == 0 || deviceConnection == NULL) return;
+
+	// Like values with extra data, changes are not sent while disconnected
+	if(!deviceConnection->connected){
+		pendingLength = 0;
+		return;
+	}
+
+	// Send queue is busy and has no room: keep (coalesce) or discard values by Device::sendPolicy
+	if(deviceConnection->txQueued() > 0 && deviceConnection->txFree() < pendingLength * VALUE_FRAME_SIZE){
+		uint8_t kept = 0;
+		for (int p = 0; p < pendingLength; p++) {
+			if(pendingValues[p]->sendPolicy == Device::COALESCE) pendingValues[kept++] = pendingValues[p];
+			else deviceConnection->txDropped++;
+		}
+		pendingLength = kept;
+		return;
+	}
+
+	if(pendingLength == 1){
+		Device* device = pendingValues[0];
+		lastCMD.id = 0;
+		lastCMD.type = (uint8_t) Device::TypeToCommand(device->type);
+		lastCMD.deviceID = device->id;
+		lastCMD.value = device->currentValue;
+		deviceConnection->send(lastCMD, true, Device::decimals(device->type));
+	}else{
+		Command batch = cmd(CommandType::BATCH_VALUES, 0, pendingLength);
+		deviceConnection->send(batch, false);
+
+		for (int p = 0; p < pendingLength; p++) {
+			Device* device = pendingValues[p];
+			if(p > 0) deviceConnection->doToken();
+			deviceConnection->writeNumber(device->id);
+			deviceConnection->doToken();
+			if(Device::TypeToCommand(device->type) == CommandType::ANALOG)
+				deviceConnection->writeValue(device->currentValue, Device::decimals(device->type));
+			else
+				deviceConnection->writeNumber((long) device->currentValue);
+		}
+
+		deviceConnection->doEnd();
+	}
+
+	pendingLength = 0;
+}
+
+
+/**
+ * Publish devices with a value different of the last one published in their state topic (retained),
+ * so a dashboard gets the state of all devices when it subscribes. Values that could not be sent
+ * (like while disconnected) are tried again in next loop pass.
+ */
+void OpenDeviceClass::publishStates(){
+#if(ENABLE_STATE_TOPICS)
+	if(!deviceConnection) return;
+
+	for (uint8_t i = 0; i < deviceLength; i++) {
+		Device* device = devices[i];
+		bool published = statesPublished[i >> 3] & (1 << (i & 7));
+
+		if(!device->deviceName || (published && publishedStates[i] == device->currentValue)) continue;
+
+		if(!deviceConnection->sendState(device->deviceName, device->currentValue, Device::decimals(device->type))) return;
+
+		publishedStates[i] = device->currentValue;
+		statesPublished[i >> 3] |= (1 << (i & 7));
+	}
+#endif
+}
 
 void OpenDeviceClass::send(Command cmd){
 	deviceConnection->send(cmd, true);
@@ -389,14 +536,15 @@ void OpenDeviceClass::debugChange(Device* device){
 			deviceConnection->print("DB:CHANGE ");
 			deviceConnection->print(device->deviceName);
 			deviceConnection->print("=");
-			deviceConnection->print(device->currentValue);
+			printValue(*deviceConnection, device->currentValue);
 			deviceConnection->doEnd();
 		}else{
 			#if(ENABLE_SERIAL)
 			Serial.print("DB:CHANGE:");
 			Serial.print(device->deviceName);
 			Serial.print("=");
-			Serial.println(device->currentValue, DEC);
+			printValue(Serial, device->currentValue);
+			Serial.println();
 			#endif
 		}
 	}
@@ -458,6 +606,10 @@ Device* OpenDeviceClass::addDevice(const char* name, Device& device){
 		Logger.debug("Add Device", deviceName);
 		device.name(deviceName);
 
+		indexDevice(deviceLength - 1);
+
+		if(deviceConnection) scheduleSensors(); // added after begin
+
 		return &device;
 	} else{
 		return false;
@@ -466,6 +618,7 @@ Device* OpenDeviceClass::addDevice(const char* name, Device& device){
 
 Device* OpenDeviceClass::addDevice(const char* name, uint16_t pin, Device::DeviceType type, bool sensor, uint8_t id){
 	devices[deviceLength] = new Device(id, pin, type, sensor);
+	devices[deviceLength]->batchValues = true; // plain Device, no extra data
 	return addDevice(name, *devices[deviceLength]);
 }
 
@@ -495,9 +648,14 @@ bool OpenDeviceClass::addCommand(const char * name, void (*function)()){
 	if (commandsLength < MAX_COMMAND) {
 
 			strncpy(commands[commandsLength].command, name , MAX_COMMAND_STRLEN);
+			commands[commandsLength].hash = DeviceConnection::hash(name);
 			commands[commandsLength].function = function;
 			commandsLength++;
 
+			uint8_t slot = commands[commandsLength - 1].hash & (COMMAND_INDEX_SIZE - 1);
+			while (commandIndex[slot]) slot = (slot + 1) & (COMMAND_INDEX_SIZE - 1);
+			commandIndex[slot] = commandsLength;
+
 			return true;
 		} else{
 			return false;
@@ -505,64 +663,183 @@ bool OpenDeviceClass::addCommand(const char * name, void (*function)()){
 }
 
 
+/** Interrupt sensor changed less than readInterval after last reading (at 'time') */
+static inline bool debouncing(Device *sensor, uint32_t time){
+	return sensor->readInterval > 0 && sensor->readLastTime != 0 && (int32_t) (time - sensor->readLastTime) < sensor->readInterval;
+}
+
 void OpenDeviceClass::checkSensorsStatus(){
 
 	// Arduino DOC (http://arduino.cc/en/Reference/analogRead):
 	// Takes about 100 microseconds (0.0001 s) to read an analog input, so the maximum reading rate is about 10,000 times
 
+	// Sensors with readInterval: only the ones due are read, the first of queue has the nearest time
+	uint32_t now = millis();
+	while(sensorQueueLength > 0 && (int32_t) (now - sensorDeadline(sensorQueue[0])) >= 0){
+		Device *sensor = devices[sensorQueue[0]];
+		sensor->readLastTime = now;
+		bool changed = sensor->hasChanged();
+		sortSensorQueue(0); // move to its next reading time
+		if(changed) syncSensor(sensor);
+	}
+
 	if(time == 0) time = micros();
 
 	// don't sample analog/digital more than {READING_INTERVAL} ms
 	bool pollingReady = micros() - time > READING_INTERVAL;
 
-	for (int i = 0; i < deviceLength; i++) {
-
-		if(! devices[i]->sensor ) continue;
+	if(pollingReady){
+		for (uint8_t i = 0; i < pollSensorsLength; i++) {
+			Device *sensor = devices[pollSensors[i]];
+			if(sensor->canReadSensor() && sensor->hasChanged()){ // readInterval can be set after begin
+				syncSensor(sensor);
+			}
+		}
 
-		bool syncCurrent = false;
+		time = micros(); // reset
+	}
 
-		bool canReadSensor = (pollingReady && devices[i]->canReadSensor()); // check elapsed interval (if exist)
+	// Interrupt sensors, changes recorded by onInterruptReceived (in order)
+	SensorEvent event;
+	while(sensorEvents.pop(event)){
+		Device *sensor = devices[event.position];
+
+		// Debounce, like canReadSensor() but using time of interrupt. The last edge may be in
+		// this window, so the sensor is read again when it closes
+		if(debouncing(sensor, event.time)){
+			noInterrupts();
+			pendingSensors[event.position >> 3] |= (1 << (event.position & 7));
+			interrupts();
+			continue;
+		}
+		sensor->readLastTime = event.time;
 
-		// polling mode
-		if(canReadSensor && devices[i]->interruptEnabled == false && devices[i]->hasChanged()){
-			syncCurrent = true;
-		// interrupt mode
-		}else if(devices[i]->interruptEnabled == true && devices[i]->needSync  ){
-			syncCurrent = true;
+		bool changed;
+		if(event.value == SENSOR_EVENT_UNREAD){
+			changed = sensor->hasChanged();
+		}else{
+			value_t value = sensor->inverted ? !event.value : event.value;
+			changed = (sensor->currentValue != value);
+			sensor->currentValue = value;
 		}
 
-		if(syncCurrent){
-			if(devices[i]->notifyListeners()){
-				onSensorChanged(devices[i]);
+		if(changed) syncSensor(sensor);
+	}
+
+	// Interrupt sensors with changes not in 'sensorEvents' (queue full or debounce window)
+	now = millis();
+	for (uint8_t i = 0; i < sizeof(pendingSensors); i++) {
+		if(!pendingSensors[i]) continue;
+
+		noInterrupts();
+		uint8_t pending = pendingSensors[i];
+		pendingSensors[i] = 0;
+		interrupts();
+
+		uint8_t waiting = 0; // still in debounce window
+		for (uint8_t bit = 0; pending; bit++, pending >>= 1) {
+			if(!(pending & 1)) continue;
+
+			Device *sensor = devices[i * 8 + bit];
+			if(debouncing(sensor, now)){
+				waiting |= (1 << bit);
+				continue;
 			}
-			devices[i]->needSync = false;
+
+			sensor->readLastTime = now;
+			if(sensor->hasChanged()) syncSensor(sensor);
+		}
+
+		if(waiting){
+			noInterrupts();
+			pendingSensors[i] |= waiting;
+			interrupts();
 		}
+	}
+
+}
+
+void OpenDeviceClass::syncSensor(Device* sensor){
+	if(sensor->notifyListeners()){
+		onSensorChanged(sensor);
+	}
+	sensor->needSync = false;
+}
+
+/**
+ * Build reading schedule of sensors (called on begin, after sensors are configured).
+ * Sensors with readInterval go to 'sensorQueue', the others are polled and interrupt sensors are
+ * handled only when recorded in 'sensorEvents', so checkSensorsStatus don't need to scan all devices.
+ */
+void OpenDeviceClass::scheduleSensors(){
+
+	sensorQueueLength = 0;
+	pollSensorsLength = 0;
 
+	for (uint8_t i = 0; i < deviceLength; i++) {
+		Device *device = devices[i];
+
+		if(!device->sensor || device->interruptEnabled) continue;
+
+		if(device->readInterval > 0){
+			// sift up
+			uint8_t index = sensorQueueLength++;
+			while(index > 0){
+				uint8_t parent = (index - 1) / 2;
+				if((int32_t) (sensorDeadline(i) - sensorDeadline(sensorQueue[parent])) >= 0) break;
+				sensorQueue[index] = sensorQueue[parent];
+				index = parent;
+			}
+			sensorQueue[index] = i;
+		}else{
+			pollSensors[pollSensorsLength++] = i;
+		}
 	}
 
-	if(pollingReady) time = micros(); // reset
+}
+
+/** Next reading time of a sensor in 'sensorQueue', at least 1ms after the last (readInterval can be cleared after begin) */
+uint32_t OpenDeviceClass::sensorDeadline(uint8_t position){
+	Device *sensor = devices[position];
+	return (uint32_t) sensor->readLastTime + (uint32_t) (sensor->readInterval > 0 ? sensor->readInterval : 1);
+}
+
+/** Restore order of 'sensorQueue' after the reading time of sensor at 'index' was moved forward (sift down) */
+void OpenDeviceClass::sortSensorQueue(uint8_t index){
 
+	uint8_t position = sensorQueue[index];
+	uint32_t deadline = sensorDeadline(position);
+
+	while(true){
+		uint8_t child = index * 2 + 1;
+		if(child >= sensorQueueLength) break;
+
+		if(child + 1 < sensorQueueLength && (int32_t) (sensorDeadline(sensorQueue[child + 1]) - sensorDeadline(sensorQueue[child])) < 0){
+			child++;
+		}
 
+		if((int32_t) (sensorDeadline(sensorQueue[child]) - deadline) >= 0) break;
 
+		sensorQueue[index] = sensorQueue[child];
+		index = child;
+	}
+
+	sensorQueue[index] = position;
 }
 
 void OpenDeviceClass::setValue(uint8_t id, value_t value){
 
-    for (int i = 0; i < deviceLength; i++) {
-    	if(devices[i]->id == id){
-    		devices[i]->setValue(value, false);
-    		sendValue(devices[i]);
-    		break;
-    	}
-    }
+	Device* device = getDevice(id);
+
+	if(device != NULL){
+		device->setValue(value, false);
+		sendValue(device);
+	}
 }
 
+/** Send value of device to server (at the end of current loop pass) */
 void OpenDeviceClass::sendValue(Device* device){
-	lastCMD.id = 0;
-	lastCMD.type = (uint8_t) Device::TypeToCommand(device->type);
-	lastCMD.deviceID = device->id;
-	lastCMD.value = device->currentValue;
-	deviceConnection->send(lastCMD, true);
+	queueValue(device);
 }
 
 
@@ -579,24 +856,13 @@ void OpenDeviceClass::sendToAll(value_t value){
 
 Device* OpenDeviceClass::getDevice(uint8_t id){
 
-//	Serial.print("DB: getDevice :: size: ");
-//	Serial.print(deviceLength, DEC);
-//	Serial.print(" > ");
-
-    for (int i = 0; i < deviceLength; i++) {
+	uint8_t slot = id & (DEVICE_INDEX_SIZE - 1);
 
-//    	Serial.print(devices[i]->id);
-//    	Serial.print(",");
-
-    	if(devices[i]->id == id){
-//    		Serial.println("DB: getDevice TRUE");
-//    		Serial.write(ACK_BIT);
-    		return devices[i];
-    	}
-    }
-
-//	Serial.println("DB: getDevice FALSE");
-//	Serial.write(ACK_BIT);
+	while (idIndex[slot]) {
+		Device* device = devices[idIndex[slot] - 1];
+		if(device->id == id) return device;
+		slot = (slot + 1) & (DEVICE_INDEX_SIZE - 1);
+	}
 
     return NULL;
 }
@@ -612,18 +878,89 @@ Device* OpenDeviceClass::getDeviceAt(uint8_t index){
 
 Device* OpenDeviceClass::getDevice(const char* name){
 
+	if(name == NULL) return NULL;
 
-    for (int i = 0; i < deviceLength; i++) {
-
-    	if(strcmp(devices[i]->deviceName,name) == 0){
-    		return devices[i];
-    	}
-    }
+	uint8_t slot = hashName(name) & (DEVICE_INDEX_SIZE - 1);
 
+	while (nameIndex[slot]) {
+		Device* device = devices[nameIndex[slot] - 1];
+		if(device->deviceName != NULL && strcmp(device->deviceName, name) == 0) return device;
+		slot = (slot + 1) & (DEVICE_INDEX_SIZE - 1);
+	}
 
     return NULL;
 }
 
+/**
+ * Add device (position in 'devices') to ID and name tables.
+ * Collisions use next free slot, so devices with same ID are found in order they were added.
+ */
+void OpenDeviceClass::indexDevice(uint8_t position){
+
+	Device* device = devices[position];
+
+	uint8_t slot = device->id & (DEVICE_INDEX_SIZE - 1);
+	while (idIndex[slot]) slot = (slot + 1) & (DEVICE_INDEX_SIZE - 1);
+	idIndex[slot] = position + 1;
+
+	if(device->deviceName != NULL){
+		slot = hashName(device->deviceName) & (DEVICE_INDEX_SIZE - 1);
+		while (nameIndex[slot]) slot = (slot + 1) & (DEVICE_INDEX_SIZE - 1);
+		nameIndex[slot] = position + 1;
+	}
+}
+
+/** Rebuild tables, must be called when IDs are changed (Ex: SYNC_DEVICES_ID) */
+void OpenDeviceClass::indexDevices(){
+
+	memset(idIndex, 0, sizeof(idIndex));
+	memset(nameIndex, 0, sizeof(nameIndex));
+
+	for (int i = 0; i < deviceLength; i++) {
+		indexDevice(i);
+	}
+}
+
+/**
+ * Build table of devices by interrupt pin (used by onInterruptReceived) and attach the interrupts.
+ * Devices of an IOExtender use its interruptPin(), so many devices can share the same pin.
+ */
+void OpenDeviceClass::indexInterrupts(){
+
+	memset(interruptIndex, 0, sizeof(interruptIndex));
+
+	// Reverse order, so devices of same pin are kept in order of 'devices'
+	for (uint8_t i = deviceLength; i-- > 0;) {
+		Device *device = devices[i];
+
+		if(!device->interruptEnabled) continue;
+
+		int16_t pin = device->getIOExtender() ? device->getIOExtender()->interruptPin() : device->pin;
+
+		if(pin < 0 || pin >= INTERRUPT_PINS){
+			Logger.debug("Interrupt not supported", device->name());
+			device->interruptEnabled = false; // use polling
+			continue;
+		}
+
+		interruptNext[i] = interruptIndex[pin];
+		interruptIndex[pin] = i + 1;
+
+		#if(ENABLE_DEVICE_INTERRUPTION)
+			if(!interruptNext[i]){ // pin not attached yet
+				PIN_INTERRUPT = &arduinoInterruptedPin;
+				enableInterrupt(pin, &(OpenDeviceClass::onInterruptReceived), device->interruptMode);
+			}
+		#endif
+	}
+}
+
+uint8_t OpenDeviceClass::hashName(const char* name){
+	uint8_t hash = 0;
+	while (*name) hash = hash * 31 + *name++;
+	return hash;
+}
+
 uint8_t * OpenDeviceClass::generateID(uint8_t apin){
 
 	if (Config.id[0] == 0 && Config.id[1] == 0) { // not saved
@@ -777,14 +1114,15 @@ void OpenDeviceClass::loadDevicesFromStorage(){
 					device->id = Config.devices[i];
 
 					if(! (device->sensor && device->type == Device::DIGITAL)){ // ignore digital sensors, and board
-						device->setValue(Config.devicesState[i], false);
+						device->setValue(unpackState(i), false);
 					}
 
 					//Logger.debug(device->deviceName, Config.devicesState[i]);
 					if(Config.debugMode){
 						Serial.print(device->deviceName);
 						Serial.print(" = ");
-						Serial.println(Config.devicesState[i]);
+						printValue(Serial, unpackState(i));
+						Serial.println();
 					}
 
 				}
@@ -796,4 +1134,89 @@ void OpenDeviceClass::loadDevicesFromStorage(){
 	Config.devicesLength = deviceLength;
 }
 
+/*
+ * Config.devicesState is packed by DeviceType: one bit for each DIGITAL device (by position),
+ * followed by the values of the other devices, in order, with stateSize() bytes.
+ * FLOAT2/FLOAT4 are saved in fixed point (value * 100 / 10000).
+ */
+
+uint8_t OpenDeviceClass::stateSize(Device::DeviceType type){
+	switch (type) {
+		case Device::DIGITAL: return 0; // bit
+		case Device::CHARACTER: return 1;
+		case Device::ANALOG:
+		case Device::ANALOG_SIGNED: return 2;
+		default: return 4; // NUMERIC, FLOAT2, FLOAT4, BOARD...
+	}
+}
+
+uint16_t OpenDeviceClass::stateOffset(uint8_t position){
+	uint16_t offset = (MAX_DEVICE + 7) / 8; // bits of DIGITAL devices
+	for (uint8_t i = 0; i < position; i++) {
+		offset += stateSize(devices[i]->type);
+	}
+	return offset;
+}
+
+/**
+ * Store value of device in Config.devicesState.
+ * Return false if the stored value has not changed, otherwise bytes changed are in 'offset' and 'size'.
+ */
+bool OpenDeviceClass::packState(uint8_t position, uint8_t &offset, uint8_t &size){
+
+	Device *device = devices[position];
+	size = stateSize(device->type);
+
+	if(size == 0){
+		offset = position >> 3;
+		size = 1;
+		uint8_t bits = Config.devicesState[offset];
+		if(device->currentValue) bits |= (1 << (position & 7));
+		else bits &= ~(1 << (position & 7));
+		if(bits == Config.devicesState[offset]) return false;
+		Config.devicesState[offset] = bits;
+		return true;
+	}
+
+	int32_t packed;
+	switch (device->type) {
+		case Device::FLOAT2:
+		case Device::FLOAT2_SIGNED: packed = valueToScaled(device->currentValue, 100); break;
+		case Device::FLOAT4: packed = valueToScaled(device->currentValue, 10000); break;
+		default: packed = (int32_t) device->currentValue;
+	}
+
+	uint16_t at = stateOffset(position);
+	if(at + size > DEVICES_STATE_SIZE) return false; // not saved (see DEVICES_STATE_SIZE)
+
+	offset = at;
+	uint8_t *state = Config.devicesState + offset;
+	if(memcmp(state, &packed, size) == 0) return false; // little endian, low bytes
+
+	memcpy(state, &packed, size);
+	return true;
+}
+
+value_t OpenDeviceClass::unpackState(uint8_t position){
+
+	Device *device = devices[position];
+	uint8_t size = stateSize(device->type);
+
+	if(size == 0) return (Config.devicesState[position >> 3] >> (position & 7)) & 1;
+
+	uint16_t offset = stateOffset(position);
+	if(offset + size > DEVICES_STATE_SIZE) return device->currentValue; // not saved
+
+	int32_t packed = 0;
+	memcpy(&packed, Config.devicesState + offset, size);
+
+	switch (device->type) {
+		case Device::ANALOG_SIGNED: return (int16_t) packed;
+		case Device::FLOAT2:
+		case Device::FLOAT2_SIGNED: return valueFromScaled(packed, 100);
+		case Device::FLOAT4: return valueFromScaled(packed, 10000);
+		default: return packed;
+	}
+}
+
 OpenDeviceClass ODev;
@@ -25,12 +25,24 @@
 #include "devices/CustomSensor.h"
 #include "utility/Logger.h"
 #include "utility/Timeout.h"
+#include "utility/LoopProfiler.h"
+#include "utility/SystemStats.h"
+#include "utility/SensorEventQueue.h"
 #include "utility/build_defs.h"
 
 using namespace od;
 
 extern volatile uint8_t* PIN_INTERRUPT;
 
+#if(ENABLE_LOOP_PROFILER)
+// Time from 'mark' to now is added to stage, 'mark' is moved to now
+#define PROFILE_MARK(mark) uint32_t mark = micros()
+#define PROFILE(stage, mark) { uint32_t now = micros(); profiler.add(stage, now - mark); mark = now; }
+#else
+#define PROFILE_MARK(mark)
+#define PROFILE(stage, mark)
+#endif
+
 #if(ENABLE_DEVICE_INTERRUPTION) // if config.h
 #define EI_ARDUINO_INTERRUPTED_PIN
 #define LIBCALL_ENABLEINTERRUPT
@@ -53,6 +65,7 @@ private:
 
 	typedef struct {
 				char command[MAX_COMMAND_STRLEN];
+				uint16_t hash; // DeviceConnection::hash of full name
 				void (*function)();
 	} CommandCallback;
 
@@ -69,6 +82,36 @@ private:
 	Timeout resetTimer;
 	unsigned long loops=0; // loop couting debug (trace performace problems)
 
+	// CPU usage: time spent in loop() since 'usageStart' (reset by CPU_USAGE_REPORT)
+	uint32_t busyTime;
+	uint32_t busyLoops;
+	uint32_t usageStart;
+
+	// Device values changed in current loop pass, sent together by sendPendingValues()
+	Device* pendingValues[MAX_DEVICE];
+	uint8_t pendingLength;
+
+	// Hash tables (open addressing) with position in 'devices' + 1, 0 is empty
+	uint8_t idIndex[DEVICE_INDEX_SIZE];
+	uint8_t nameIndex[DEVICE_INDEX_SIZE];
+	uint8_t commandIndex[COMMAND_INDEX_SIZE]; // position in 'commands' + 1, 0 is empty
+
+	// Sensor scheduling (see checkSensorsStatus), positions in 'devices'
+	uint8_t sensorQueue[MAX_DEVICE];   // sensors with readInterval, min-heap ordered by next reading time
+	uint8_t sensorQueueLength;
+	uint8_t pollSensors[MAX_DEVICE];   // sensors without readInterval, read every READING_INTERVAL
+	uint8_t pollSensorsLength;
+	uint8_t interruptIndex[INTERRUPT_PINS]; // first device (position + 1) with interrupt on pin, 0 is none
+	uint8_t interruptNext[MAX_DEVICE];      // next device (position + 1) sharing the same interrupt pin
+	SensorEventQueue sensorEvents;     // changes of interrupt sensors, in order of arrival
+	volatile uint8_t pendingSensors[(MAX_DEVICE + 7) / 8]; // interrupt sensors with changes lost by a full 'sensorEvents' (bitmap)
+
+#if(ENABLE_STATE_TOPICS)
+	// Values published in state topics (see publishStates)
+	value_t publishedStates[MAX_DEVICE];
+	uint8_t statesPublished[(MAX_DEVICE + 7) / 8]; // devices with a value in 'publishedStates' (bitmap)
+#endif
+
 
 	// Internal Listeners..
 	// NOTE: Static because: deviceConnection->setDefaultListener
@@ -76,6 +119,34 @@ private:
 
 	void onSensorChanged(Device* sensor);
 
+	void queueValue(Device* device);
+
+	void indexDevice(uint8_t position);
+
+	void indexDevices();
+
+	static uint8_t hashName(const char* name);
+
+	void indexInterrupts();
+
+	uint32_t sensorDeadline(uint8_t position);
+
+	void sortSensorQueue(uint8_t index);
+
+	void syncSensor(Device* sensor);
+
+	bool packState(uint8_t position, uint8_t &offset, uint8_t &size);
+
+	value_t unpackState(uint8_t position);
+
+	uint16_t stateOffset(uint8_t position);
+
+	static uint8_t stateSize(Device::DeviceType type);
+
+	void sendPendingValues();
+
+	void publishStates();
+
 	void notifyReceived(ResponseStatus::ResponseStatus status);
 
 	// Utils....
@@ -103,6 +174,10 @@ public:
 	Scheduler scheduler;
 #endif
 
+#if(ENABLE_LOOP_PROFILER)
+	LoopProfiler profiler;
+#endif
+
 
 	OpenDeviceClass();
 	// virtual ~OpenDeviceClass();
@@ -115,24 +190,45 @@ public:
 			deviceConnection->setStream(&conn);
 		#endif
 
+		uint32_t loopStart = micros();
+		PROFILE_MARK(start);
+
 		_loop();
 
+		PROFILE_MARK(mark);
+
 		if(messageReceived){
 			onMessageReceivedImpl();
 			deviceConnection->flush();
+			PROFILE(LoopStage::DISPATCH, mark);
 		}
 
 		#ifdef _TASKSCHEDULER_H_
 			scheduler.execute();
+			PROFILE(LoopStage::SCHEDULER, mark);
 		#endif
 
 		#if defined(__ARDUINO_OTA_H)
 			RemoteUpdate.check();
+			PROFILE(LoopStage::REMOTE_UPDATE, mark);
 		#endif
 
 		#if(ENABLE_ALEXA_PROTOCOL)
 			Alexa.loop();
+			PROFILE(LoopStage::ALEXA, mark);
+		#endif
+
+		sendPendingValues();
+		#if(ENABLE_STATE_TOPICS)
+			publishStates();
 		#endif
+		if(deviceConnection) deviceConnection->drainTx();
+		PROFILE(LoopStage::SEND, mark);
+
+		PROFILE(LoopStage::LOOP, start);
+
+		busyTime += micros() - loopStart;
+		busyLoops++;
 	};
 
 
@@ -359,6 +455,12 @@ void begin(usb_serial_class &serial, unsigned long baud){
 
 	void checkSensorsStatus();
 
+	/**
+	 * Build reading schedule of sensors. Called on begin and when a device is added after it,
+	 * call it again if readInterval of a sensor is changed after begin.
+	 */
+	void scheduleSensors();
+
 	static void onInterruptReceived();
 
 	/** When enabled OpenDevice will be sending a PING message to connection to inform you that everything is OK. <br/>
@@ -480,6 +582,8 @@ void begin(usb_serial_class &serial, unsigned long baud){
 	}
 
 	inline String readString() { return deviceConnection->readString(); }
+	inline Slice readSlice() { return deviceConnection->readSlice(); }
+	inline Slice readList() { return deviceConnection->readList(); }
 	inline int readInt(){ return deviceConnection->readInt(); }
 	inline long readLong(){ return deviceConnection->readLong(); }
 	inline float readFloat(){ return deviceConnection->readFloat(); }
@@ -521,15 +625,53 @@ void begin(usb_serial_class &serial, unsigned long baud){
 			} else {
 				notifyReceived(ResponseStatus::NOT_FOUND);
 			}
+		// Set value of several devices: /7/id/0/length/deviceID/value/.../deviceID/value
+		} else if (cmd.type == CommandType::BATCH_VALUES) {
+
+			ResponseStatus::ResponseStatus status = ResponseStatus::SUCCESS;
+
+			// Length comes from the wire: limited to MAX_DEVICE and to the pairs really received
+			uint8_t length = 0;
+			if (cmd.value < 0 || cmd.value > MAX_DEVICE) status = ResponseStatus::BAD_REQUEST;
+			else length = (uint8_t) cmd.value;
+
+			for (uint8_t i = 0; i < length; i++) {
+				if (!conn->hasNextNumber()) {
+					status = ResponseStatus::BAD_REQUEST;
+					break;
+				}
+				uint8_t deviceID = conn->readInt();
+				if (!conn->hasNextNumber()) {
+					status = ResponseStatus::BAD_REQUEST;
+					break;
+				}
+				value_t value = conn->readFloat();
+				Device *foundDevice = getDevice(deviceID);
+				if (foundDevice != NULL) {
+					foundDevice->setValue(value, false);
+					debugChange(foundDevice);
+				} else {
+					status = ResponseStatus::NOT_FOUND;
+				}
+			}
+
+			notifyReceived(status);
+
 		// User-defined command, this is an easy way to extend OpenDevice protocol.
 		} else if (cmd.type == CommandType::USER_COMMAND) {
-			String name = conn->readString();
-			for (int i = 0; i < commandsLength; i++) {
-				// if(debugMode){ debug("Call function:"); debug(name); }
-				if (name.equals(commands[i].command)) {
+			// Name is read in place (no String) and found by its hash, see addCommand
+			Slice name = conn->readSlice();
+			uint16_t hash = DeviceConnection::hash(name);
+
+			uint8_t slot = hash & (COMMAND_INDEX_SIZE - 1);
+			while (commandIndex[slot]) {
+				CommandCallback *callback = &commands[commandIndex[slot] - 1];
+				if (callback->hash == hash && name.equals(callback->command, MAX_COMMAND_STRLEN)) { // names can share a hash
 					notifyReceived(ResponseStatus::SUCCESS);
-					(*commands[i].function)();
+					(*callback->function)();
+					break;
 				}
+				slot = (slot + 1) & (COMMAND_INDEX_SIZE - 1);
 			}
 		} else if (cmd.type == CommandType::PING_REQUEST) {
 
@@ -539,12 +681,116 @@ void begin(usb_serial_class &serial, unsigned long baud){
 
 			reset();
 
+		} else if (cmd.type == CommandType::MEMORY_REPORT) {
+
+			conn->doStart();
+			conn->print(CommandType::MEMORY_REPORT);
+			conn->doToken();
+			conn->print(cmd.id);
+			conn->doToken();
+			conn->print(SystemStats::freeMemory());
+			conn->doToken();
+			conn->print(SystemStats::largestFreeBlock());
+			conn->doToken();
+			conn->print(SystemStats::fragmentation());
+			conn->doToken();
+			conn->print(SystemStats::minFreeStack());
+			conn->doEnd();
+
+		} else if (cmd.type == CommandType::CPU_TEMPERATURE_REPORT) {
+
+			float temperature = SystemStats::cpuTemperature();
+
+			if(isnan(temperature)){
+				notifyReceived(ResponseStatus::NOT_IMPLEMENTED);
+			}else{
+				conn->doStart();
+				conn->print(CommandType::CPU_TEMPERATURE_REPORT);
+				conn->doToken();
+				conn->print(cmd.id);
+				conn->doToken();
+				conn->print(temperature);
+				conn->doEnd();
+			}
+
+		// Usage is the time spent in loop() since last report
+		} else if (cmd.type == CommandType::CPU_USAGE_REPORT) {
+
+			uint32_t elapsed = micros() - usageStart;
+
+			conn->doStart();
+			conn->print(CommandType::CPU_USAGE_REPORT);
+			conn->doToken();
+			conn->print(cmd.id);
+			conn->doToken();
+			conn->print(elapsed ? (uint8_t) ((uint64_t) busyTime * 100 / elapsed) : 0);
+			conn->doToken();
+			conn->print(elapsed ? (uint32_t) ((uint64_t) busyLoops * 1000000 / elapsed) : 0);
+			conn->doToken();
+			conn->print(conn->rxBytes);
+			conn->doToken();
+			conn->print(conn->txBytes);
+			conn->doToken();
+			conn->print(conn->rxErrors);
+			conn->doToken();
+			conn->print(conn->rxOverflows);
+			conn->doToken();
+			conn->print(conn->txDropped);
+			conn->doToken();
+			conn->print(conn->txStalls);
+			conn->doEnd();
+
+			busyTime = 0;
+			busyLoops = 0;
+			usageStart = micros();
+
+		// Send: LOOP_PROFILE_REPORT;ID;Index;Length;[name,count,min,avg,max,p99] (times in us), one message per stage
+		} else if (cmd.type == CommandType::LOOP_PROFILE_REPORT) {
+
+			#if(ENABLE_LOOP_PROFILER)
+				conn->cork();
+
+				for (uint8_t i = 0; i < LoopStage::COUNT; ++i) {
+					conn->doStart();
+					conn->print(CommandType::LOOP_PROFILE_REPORT);
+					conn->doToken();
+					conn->print(cmd.id); // cmd index
+					conn->doToken();
+					conn->print(i + 1); // track current index
+					conn->doToken();
+					conn->print(LoopStage::COUNT);
+					conn->doToken();
+					conn->print('[');
+					profiler.print(i, *conn);
+					conn->print(']');
+					conn->doEnd();
+				}
+
+				conn->uncork();
+
+				if(cmd.value == 1) profiler.reset();
+			#else
+				notifyReceived(ResponseStatus::NOT_IMPLEMENTED);
+			#endif
+
+				// Negotiate framing of this connection, response is sent using the current one
+		} else if (cmd.type == CommandType::FRAME_FORMAT) {
+
+			if(conn->acceptFrameFormat((uint8_t) cmd.value)){
+				notifyReceived(ResponseStatus::SUCCESS);
+				conn->setFrameFormat((uint8_t) cmd.value);
+			}else{
+				notifyReceived(ResponseStatus::NOT_IMPLEMENTED);
+			}
+
 		// Send response: GET_DEVICES_RESPONSE;ID;Index;Length;[ID, PIN, VALUE, TARGET, SENSOR?, TYPE];
 		// NOTE: This message is sent to each device
 		} else if (cmd.type == CommandType::GET_DEVICES) {
 
 			LOG_DEBUG("GET_DEVICES", deviceLength);
 
+			conn->cork(); // responses are written together
+
 			for (int i = 0; i < deviceLength; ++i) {
 
 				Device *device = getDeviceAt(i);
@@ -567,6 +813,8 @@ void begin(usb_serial_class &serial, unsigned long baud){
 
 			}
 
+			conn->uncork();
+
 	  // Save devices ID on storage
 		} else if (cmd.type == CommandType::SYNC_DEVICES_ID) {
 
@@ -596,6 +844,8 @@ void begin(usb_serial_class &serial, unsigned long baud){
 				// Serial.print("SYNC :: ");Serial.print(i);Serial.print(" => ");Serial.println(devices[i]->id, DEC);
 			}
 
+			indexDevices();
+
 			save();
 			notifyReceived(ResponseStatus::SUCCESS);
 
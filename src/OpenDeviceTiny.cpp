@@ -49,7 +49,7 @@ void OpenDeviceTiny::onMessageReceived(Command cmd) {
 		uint8_t pin = ODevTiny.getDevice(cmd.deviceID);
 		if (pin > 0) {
 			// FIXME: allow analog...!!
-			digitalWrite(pin, cmd.value);
+			digitalWrite(pin, (uint8_t) cmd.value);
 			ODevTiny.notifyReceived(ResponseStatus::SUCCESS);
 		} else {
 			ODevTiny.notifyReceived(ResponseStatus::NOT_FOUND);
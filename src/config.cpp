@@ -1,4 +1,5 @@
 #include "config.h"
+#include "utility/StateLog.h"
 
 namespace od {
 	ConfigClass Config = {
@@ -19,6 +20,18 @@ namespace od {
   };
 
 
+	/*
+	 * Changes of device state are saved in a StateLog stored after configuration, so a save writes
+	 * one record instead of the whole configuration. Log has the last value of each device, newer
+	 * than devicesState, unless it's 'stale' (configuration was not valid, or log is disabled/full).
+	 */
+	static StateLog& stateLog(){
+		static StateLog log(CONFIG_START + sizeof(ConfigClass), STATE_LOG_SIZE);
+		return log;
+	}
+
+	static bool stateLogStale = false;
+
 	/**
 	 * Load configuration from storage (EEPROM).
 	 * Check if exist, if not, use default values
@@ -26,9 +39,21 @@ namespace od {
 	void ConfigClass::load(){
 		if(check()){
 			EEPROM.get(CONFIG_START, Config);
+			stateLog().load(devicesState, sizeof(devicesState)); // last changes
+		} else if(hasVersion(CONFIG_VERSION_V1)){
+			// Fields before devicesState have the same layout: keep them (server, appID, module name, devices),
+			// state of devices was a value_t each and is reset. New layout is written on next save
+			uint8_t *data = (uint8_t *) this;
+			for (uint16_t i = 0; i < offsetof(ConfigClass, devicesState); i++) data[i] = EEPROM.read(CONFIG_START + i);
+			memcpy(version, CONFIG_VERSION, sizeof(version));
+			memset(this->devicesState, 0, sizeof(devicesState));
+			stateLog().load(NULL, 0);
+			stateLogStale = true;
 		} else{
 			memset(this->devices, 0, MAX_DEVICE); // initialize defaults as 0
-			memset(this->devicesState, 0, MAX_DEVICE); // initialize defaults as 0
+			memset(this->devicesState, 0, sizeof(devicesState)); // initialize defaults as 0
+			stateLog().load(NULL, 0); // stored state is not valid, only find the end of log
+			stateLogStale = true;
 			// save(); // init and save defaults
 		}
 
@@ -38,16 +63,43 @@ namespace od {
 	 * Check if exist a valid configuration (memory layout) in EEPROM
 	 */
 	bool ConfigClass::check(){
-		return (EEPROM.read(CONFIG_START + 0) == CONFIG_VERSION[0] &&
-						EEPROM.read(CONFIG_START + 1) == CONFIG_VERSION[1] &&
-						EEPROM.read(CONFIG_START + 2) == CONFIG_VERSION[2]);
+		return hasVersion(CONFIG_VERSION);
 	}
 
-  /** Save current configuration to storage */
+	bool ConfigClass::hasVersion(const char *version){
+		return (EEPROM.read(CONFIG_START + 0) == version[0] &&
+						EEPROM.read(CONFIG_START + 1) == version[1] &&
+						EEPROM.read(CONFIG_START + 2) == version[2]);
+	}
+
+  /** Save current configuration to storage, only bytes that changed are written */
   void ConfigClass::save(){
-    EEPROM.put(CONFIG_START, Config);
+
+	const uint8_t *data = (const uint8_t *) this;
+	for (uint16_t i = 0; i < sizeof(ConfigClass); i++) {
+		if (EEPROM.read(CONFIG_START + i) != data[i]) EEPROM.write(CONFIG_START + i, data[i]);
+	}
+
+	// devicesState is newer than log
+	if (stateLogStale) {
+		stateLog().clear();
+		stateLogStale = false;
+	}
+
+	commit();
+  }
+
+  void ConfigClass::saveState(uint8_t offset, uint8_t size){
+	// Log is valid only with a saved configuration
+	if (!stateLogStale && check() && stateLog().append(offset, devicesState + offset, size)) return;
+
+	stateLogStale = true;
+	save(); // log is disabled or full
+  }
+
+  void ConfigClass::commit(){
 	#if defined(ESP8266)
-		EEPROM.commit();
+		EEPROM.commit(); // does nothing if there are no changes
 	#endif
   }
 
@@ -60,6 +112,8 @@ namespace od {
 		  EEPROM.write(i, 0);
 		}
 
+		stateLogStale = true;
+
 		#if defined(ESP8266)
 		EEPROM.commit();
 		#endif
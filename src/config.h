@@ -38,7 +38,8 @@
 #define ENABLE_SERIAL     1
 
 #define API_VERSION   "0.5.2" // software version of this library (used in build_defs.h make X.X.X pattern)
-#define CONFIG_VERSION "cv1"  // version of config layout
+#define CONFIG_VERSION "cv2"  // version of config layout
+#define CONFIG_VERSION_V1 "cv1" // previous layout (value_t per device in devicesState), migrated by ConfigClass::load
 #define CONFIG_START 0        // start address in EEPROM
 
 #define DEFAULT_BAUD 115200
@@ -55,10 +56,17 @@
 #define SHOW_DEBUG_STATE 1          // Print debug (trace performace problems) information in interval of 'SAVE_DEVICE_INTERVAL'
 
 #define RECONNECT_TIMEOUT 30000	//ms
+#define MQTT_RECONNECT_MIN 1000 // ms, first wait to reconnect MQTT, doubled (up to RECONNECT_TIMEOUT) on each failure (see Backoff)
+#define MQTT_CONNECT_TIMEOUT 1000 // ms, max wait of TCP connection to broker (ESP8266, see MQTTClient::reconnect)
 #define RESET_TIMEOUT 5000     // Used in conjuntion with Config.resetPin, to add reset function for custon pin
 
 // #define ENABLE_REMOTE_WIFI_SETUP 0   // disable to reduce flash usage
 #define ENABLE_SSL 0 // disable to reduce flash/memory usage (tested only for MQTT/ESP8266)
+
+// Publish value of each device to {appID}/state/{moduleName}/{deviceName} (retained) when it changes (MQTT connections)
+#ifndef ENABLE_STATE_TOPICS
+#define ENABLE_STATE_TOPICS 0
+#endif
 #define ENABLE_ALEXA_PROTOCOL 0 // Enable Alexa/AmazonEcho direct integration (ESP8266 Only)
 #define ALEXA_MAX_DEVICES 10 // MAX 14
 
@@ -67,14 +75,39 @@
                           Another important config to save flash memory is disable UDP of UIPEthernet (UIPEthernet/utility/uipethernet-conf.h) */
 #endif
 
+#define VALUE_FRAME_SIZE 16 // approximate bytes of a value update, to check room in send queue
+
+// Time each stage of loop() (see LoopProfiler and CommandType::LOOP_PROFILE_REPORT), uses ~400 bytes of RAM
+#ifndef ENABLE_LOOP_PROFILER
+#if defined(ESP8266) || defined(ESP32)
+#define ENABLE_LOOP_PROFILER 1
+#else
+#define ENABLE_LOOP_PROFILER 0
+#endif
+#endif
+
+// Decode 4 digits per step when reading arrays (word-at-a-time, little endian 32-bit cores and x86 host builds, see tests/)
+#ifndef ENABLE_SWAR_DECODER
+#if defined(ESP8266) || defined(ESP32) || defined(__arm__) || defined(__x86_64__) || defined(__i386__)
+#define ENABLE_SWAR_DECODER 1
+#else
+#define ENABLE_SWAR_DECODER 0
+#endif
+#endif
+
 #define MAX_DEVICE_ID 255
 
 // ---- Low Memory Devices ----------
 #if defined(__AVR_ATtinyX313__) || defined(__AVR_ATtinyX4__) || defined(__AVR_ATtinyX5__)
 #define DATA_BUFFER  16
+#define TX_BUFFER 16
+#define TX_QUEUE 0
 #define MAX_DEVICE_NAME  10
 #define MAX_LISTENERS 2
 #define MAX_DEVICE 5
+#define SENSOR_EVENT_QUEUE 4 // changes of interrupt sensors waiting for loop (power of 2)
+#define STATE_LOG_SIZE 0 // EEPROM bytes after configuration to log changes of device state (see StateLog)
+#define MQTT_INBOX 0 // bytes of received MQTT messages waiting to be parsed (see MessageQueue)
 
 #define MAX_COMMAND 5 // this is used for user command callbacks
 #define MAX_COMMAND_STRLEN 5
@@ -83,8 +116,13 @@
 // ---- High Memory Devices --------
 #elif defined(ESP8266)
 #define DATA_BUFFER  256
+#define TX_BUFFER 256
+#define TX_QUEUE 512
 #define MAX_LISTENERS 5
 #define MAX_DEVICE 20
+#define SENSOR_EVENT_QUEUE 16 // changes of interrupt sensors waiting for loop (power of 2)
+#define STATE_LOG_SIZE 512 // EEPROM bytes after configuration to log changes of device state (see StateLog)
+#define MQTT_INBOX 512 // bytes of received MQTT messages waiting to be parsed (see MessageQueue)
 #define MAX_DEVICE_NAME  25
 #define MAX_COMMAND 5 // this is used for user command callbacks
 #define MAX_COMMAND_STRLEN 14
@@ -93,8 +131,13 @@
 // ---- Medium Memory Devices --------
 #else
 #define DATA_BUFFER  128
+#define TX_BUFFER 64
+#define TX_QUEUE 64
 #define MAX_LISTENERS 5
 #define MAX_DEVICE 10
+#define SENSOR_EVENT_QUEUE 8 // changes of interrupt sensors waiting for loop (power of 2)
+#define STATE_LOG_SIZE 256 // EEPROM bytes after configuration to log changes of device state (see StateLog)
+#define MQTT_INBOX 128 // bytes of received MQTT messages waiting to be parsed (see MessageQueue)
 #define MAX_DEVICE_NAME  25
 #define MAX_COMMAND 3 // this is used for user command callbacks
 #define MAX_COMMAND_STRLEN 14
@@ -102,9 +145,58 @@
 
 #endif
 
+// Bytes of packed state of devices (see ConfigClass::devicesState): 1 bit per DIGITAL, 1 byte CHARACTER, 2 bytes ANALOG, 4 bytes others.
+// Default fits any mix of types (max 256, offsets are 8-bit). It can be set smaller when most devices are DIGITAL/ANALOG,
+// values of devices that don't fit are not saved.
+#ifndef DEVICES_STATE_SIZE
+#define DEVICES_STATE_SIZE ((MAX_DEVICE + 7) / 8 + MAX_DEVICE * 4 > 256 ? 256 : (MAX_DEVICE + 7) / 8 + MAX_DEVICE * 4)
+#endif
+
+#if DEVICES_STATE_SIZE < (MAX_DEVICE + 7) / 8
+#error "DEVICES_STATE_SIZE must fit the bits of DIGITAL devices: (MAX_DEVICE + 7) / 8"
+#endif
+
+// Size of hash tables used to find devices by ID/name (power of 2, at least twice MAX_DEVICE)
+#define DEVICE_INDEX_SIZE (MAX_DEVICE <= 8 ? 16 : MAX_DEVICE <= 16 ? 32 : MAX_DEVICE <= 32 ? 64 : MAX_DEVICE <= 64 ? 128 : 256)
 
-/* Define value type for devince */
+// Pins that can be used by Device::enableInterrupt (size of table used to find devices of interrupt)
+#ifndef INTERRUPT_PINS
+#ifdef NUM_DIGITAL_PINS
+#define INTERRUPT_PINS NUM_DIGITAL_PINS
+#else
+#define INTERRUPT_PINS 32
+#endif
+#endif
+
+// Size of hash table used to dispatch USER_COMMAND (power of 2, at least twice MAX_COMMAND)
+#define COMMAND_INDEX_SIZE (MAX_COMMAND <= 4 ? 8 : MAX_COMMAND <= 8 ? 16 : 32)
+
+
+/*
+ * Define value type for devince (value_t), set VALUE_TYPE to one of:
+ * VALUE_DOUBLE (default), VALUE_FLOAT, VALUE_INT32 (integers only) or VALUE_FIXED (Q16.16, see Fixed).
+ * VALUE_INT32 and VALUE_FIXED don't use floating point to receive, compare and send values (faster on AVR).
+ * Convert values explicitly, like: (long) value, (float) value.
+ */
+#define VALUE_DOUBLE 0
+#define VALUE_FLOAT  1
+#define VALUE_INT32  2
+#define VALUE_FIXED  3
+
+#ifndef VALUE_TYPE
+#define VALUE_TYPE VALUE_DOUBLE
+#endif
+
+#if VALUE_TYPE == VALUE_FLOAT
+typedef float value_t;
+#elif VALUE_TYPE == VALUE_INT32
+typedef int32_t value_t;
+#elif VALUE_TYPE == VALUE_FIXED
+#include "utility/Fixed.h"
+typedef Fixed value_t;
+#else
 typedef double value_t;
+#endif
 
 // May be better use: https://github.com/mrRobot62/Arduino-logging-library OU -VDEBUG(see ESP8266)
 enum DebugTarget{
@@ -142,13 +234,22 @@ namespace od {
 	  uint8_t connectionMode;
 	  int8_t devicesLength;
 	  uint16_t devices[MAX_DEVICE]; // DeviceIDs
-	  value_t devicesState[MAX_DEVICE]; // Devices state
+	  uint8_t devicesState[DEVICES_STATE_SIZE]; // Devices state, packed by type (see OpenDeviceClass::packState)
 
 	  void load();
 	  void save();
 	  void clear();
 	  bool check();
 
+	  /** Check if configuration in EEPROM has this layout version */
+	  static bool hasVersion(const char *version);
+
+	  /** Save 'size' bytes of devicesState at 'offset' appending to StateLog (only these bytes are written), see STATE_LOG_SIZE */
+	  void saveState(uint8_t offset, uint8_t size);
+
+	  /** Write pending changes to storage (ESP8266 EEPROM is a copy in RAM) */
+	  void commit();
+
 	};
 
 	extern ConfigClass Config;
@@ -17,6 +17,7 @@ ELClientMqtt* EspLinkConnection::mqtt;
 StreamBuffer* EspLinkConnection::buffer;
 bool EspLinkConnection::connected = false;
 bool EspLinkConnection::received = false;
+bool EspLinkConnection::sending = false;
 
 EspLinkConnection::EspLinkConnection(Stream& serial, Stream& debug){
 	esp = new ELClient(&serial, &debug);
@@ -85,6 +86,7 @@ void EspLinkConnection::mqttData(void* response) {
 	LOG_DEBUG("MQTT REC", data.c_str());
 
 	buffer->flush();
+	sending = false;
 	received = true;
 	for (uint32_t i = 0; i < data.length(); i++) {
 		buffer->write(data[i]);
@@ -98,12 +100,23 @@ size_t EspLinkConnection::write(uint8_t v){
 		#endif
 		mqtt->publish(topic.c_str(), (const char *) buffer->_buffer);
 		flush();
+		sending = false;
 		return 1;
 	}else{ // Write to buffer
+		// First byte of a message, discard received data that shares the buffer
+		if(!sending){
+			buffer->flush();
+			sending = true;
+		}
 		return buffer->write(v);
 	}
 }
 
+/** Messages are published on ACK_BIT, so only ASCII frames are supported */
+bool EspLinkConnection::acceptFrameFormat(uint8_t format){
+	return format == FrameFormat::ASCII;
+}
+
 
 void EspLinkConnection::begin() {
 	esp->wifiCb.attach(&(EspLinkConnection::wifiCb)); // wifi status change callback, optional (delete if not desired)
@@ -44,6 +44,8 @@ public:
 	virtual bool checkDataAvalible(void);
 	virtual size_t write(uint8_t);
 
+	virtual bool acceptFrameFormat(uint8_t format);
+
 	static void wifiCb(void* response);
 	static void mqttConnected(void* response);
 	static void mqttDisconnected(void* response);
@@ -57,6 +59,7 @@ private:
 	static ELClientMqtt* mqtt;
 	static bool connected;
 	static bool received;
+	static bool sending; // message being written to buffer (published on ACK_BIT)
 
 	void init(ELClient* _esp);
 };
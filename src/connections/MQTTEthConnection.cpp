@@ -24,14 +24,14 @@
 
 namespace od {
 
-StreamBuffer* MQTTEthConnection::buffer;
-bool MQTTEthConnection::received = false;
+const uint8_t* MQTTEthConnection::payload = NULL;
+uint16_t MQTTEthConnection::payloadLength = 0;
+MessageQueue MQTTEthConnection::inbox;
 
 MQTTEthConnection::MQTTEthConnection(Client& client):
-		mqtt(client),
-		mqttTimeout(RECONNECT_TIMEOUT){
+		mqtt(client){
 
-		buffer = new StreamBuffer(_buffer, DATA_BUFFER);
+		mqttClient = new MQTTClient(mqtt, client, _buffer);
 
 }
 
@@ -42,88 +42,63 @@ MQTTEthConnection::~MQTTEthConnection() {
 void MQTTEthConnection::begin(){
 
 	Logger.debug("MQTT", "BEGIN");
-	mqtt.setServer(Config.server, MQTT_PORT);
 	mqtt.setCallback(mqttCallback);
-
-	//  Publish topic
-	topic = String(Config.appID);
-	topic += "/out/";
-	topic += Config.moduleName;
-
-	mqttConnect();
+	mqttClient->begin(MQTT_PORT);
 
 }
 
 bool MQTTEthConnection::checkDataAvalible(void){
 
-	// Reconnect MQTT if OFFLINE and not have Client (TcpServer)
-	if (mqttTimeout.expired() && !mqtt.connected()) {
-		mqttConnect();
-	}
-
-	if (mqtt.connected()){
+	// Reconnect MQTT if OFFLINE
+	if (mqttClient->reconnect()){
 		Config.keepAlive = false; // on MQTT is not required
+		payload = NULL;
 		mqtt.loop();
-		mqttTimeout.disable();
 
-		if(received){
-			setStream(buffer);
-			DeviceConnection::checkDataAvalible();
-			received = false;
-		}
+		setStream(mqttClient);
+		return parsePayload();
 
 	}else{ // TCP SERVER...
-//		if(!mqttTimeout.isEnabled()) mqttTimeout.enable();
 //		Config.keepAlive = true; // on raw TCP is  required
 //		return WifiConnection::checkDataAvalible();
-		if(!mqttTimeout.isEnabled()) mqttTimeout.enable();
 		return false;
 	}
 
 }
 
-void MQTTEthConnection::mqttCallback(char* topic, byte* payload, unsigned int length){
-	buffer->flush();
-	received = true;
-	for (uint32_t i = 0; i < length; i++) {
-		buffer->write(payload[i]);
-	}
-}
-
-size_t MQTTEthConnection::write(uint8_t v){
-	if(v == Command::ACK_BIT){ // don't write ACK
-		#if DEBUG_CON
-		LOG_DEBUG("MQTT SEND", (const char *) buffer->_buffer);
-		#endif
-		mqtt.publish(topic.c_str(), (const char *) buffer->_buffer);
-		flush();
-		return 1;
-	}else{ // Write to buffer
-		return buffer->write(v);
+/**
+ * Keep only the location of the message, it is parsed by checkDataAvalible after mqtt.loop().
+ * If older messages are still waiting, it is queued after them.
+ */
+void MQTTEthConnection::mqttCallback(char* topic, byte* data, unsigned int length){
+	if(!inbox.isEmpty()){
+		inbox.push(data, length);
+	}else{
+		payload = data;
+		payloadLength = length;
 	}
 }
 
-void MQTTEthConnection::mqttConnect(){
-
-	String clientID = String(Config.appID);
-	clientID+= "/";
-	clientID+= Config.moduleName;
-
-	String subscribe = String(Config.appID);
-	subscribe+= "/in/";
-	subscribe+= Config.moduleName;
+/**
+ * Parse next command of received messages, a message can have several commands.
+ * The last message is parsed in PubSubClient buffer, what can't wait there is moved to the inbox.
+ */
+bool MQTTEthConnection::parsePayload(){
 
-	LOG_DEBUG("MQTT", "connecting... ");
+	bool received = inbox.parse(*this, payload, payloadLength);
+	payload = NULL;
+	return received;
+}
 
-	// Attempt to connect
-	if (mqtt.connect(clientID.c_str(), Config.appID, "*")) {
-	  LOG_DEBUG("MQTT", "[connected]");
-	  mqtt.subscribe(subscribe.c_str());
-	} else {
-	  mqttTimeout.reset();
-	  LOG_DEBUG("MQTT <Fail>", mqtt.state());
-	}
+#if(ENABLE_STATE_TOPICS)
+bool MQTTEthConnection::sendState(const char *name, value_t value, uint8_t decimals){
+	return mqttClient->publishState(name, value, decimals);
+}
+#endif
 
+/** Messages are published on ACK_BIT, so only ASCII frames are supported */
+bool MQTTEthConnection::acceptFrameFormat(uint8_t format){
+	return format == FrameFormat::ASCII;
 }
 
 } /* namespace od */
@@ -35,9 +35,9 @@
 // NOTE: Please do not include OpenDevice.h this will break the preprocessors / macros
 #include "config.h"
 #include "utility/Logger.h"
-#include "utility/Timeout.h"
 #include "DeviceConnection.h"
 #include "MQTTClient.h"
+#include "utility/MessageQueue.h"
 
 #define MQTT_PORT 1883
 
@@ -55,17 +55,27 @@ public:
 
 	virtual bool checkDataAvalible(void);
 
-	virtual size_t write(uint8_t);
+	virtual bool acceptFrameFormat(uint8_t format);
+
+#if(ENABLE_STATE_TOPICS)
+	virtual bool sendState(const char *name, value_t value, uint8_t decimals);
+#endif
 
 	static void mqttCallback(char* topic, byte* payload, unsigned int length);
 
+	/** TCP connections opened to broker */
+	uint16_t connectAttempts() { return mqttClient->connectAttempts; }
+
+	/** Time (ms) without connection to broker */
+	uint32_t offlineTime() { return mqttClient->offlineTime(); }
+
 private:
-  static StreamBuffer* buffer;
-	static bool received;
-	String topic;
+	MQTTClient* mqttClient;
+	static const uint8_t* payload; // last message, parsed directly from PubSubClient buffer
+	static uint16_t payloadLength;
+	static MessageQueue inbox; // messages (or the rest of them) that can't wait in PubSubClient buffer
 	PubSubClient mqtt;
-	Timeout mqttTimeout;
-	void mqttConnect();
+	bool parsePayload();
 
 };
 
@@ -16,9 +16,12 @@
 namespace od {
 
 MQTTClient* MQTTWifiConnection::mqttClient;
+const uint8_t* MQTTWifiConnection::payload = NULL;
+uint16_t MQTTWifiConnection::payloadLength = 0;
+MessageQueue MQTTWifiConnection::inbox;
 
-MQTTWifiConnection::MQTTWifiConnection(): mqtt(ethclient), mqttTimeout(RECONNECT_TIMEOUT) {
-	mqttClient = new MQTTClient(mqtt, _buffer);
+MQTTWifiConnection::MQTTWifiConnection(): mqtt(ethclient) {
+	mqttClient = new MQTTClient(mqtt, ethclient, _buffer);
 	connected = false; // for WIFI state
 }
 
@@ -28,10 +31,8 @@ MQTTWifiConnection::~MQTTWifiConnection() {
 void MQTTWifiConnection::begin(){
 	 WifiConnection::begin();
 	 Logger.debug("MQTT", "BEGIN");
-	 mqtt.setServer(Config.server, MQTT_PORT);
 	 mqtt.setCallback(mqttCallback);
-	 mqttClient->begin();
-	 mqttConnect();
+	 mqttClient->begin(MQTT_PORT);
 }
 
 void MQTTWifiConnection::disconnect(){
@@ -44,6 +45,7 @@ bool MQTTWifiConnection::checkDataAvalible(void){
 	// Monitor Wifi State
 	if (WiFi.status() != WL_CONNECTED) {
 		hasWiFi = false;
+		mqttClient->disconnected(); // WiFi outage is offline time
 	    return false;
 	}
 
@@ -51,29 +53,27 @@ bool MQTTWifiConnection::checkDataAvalible(void){
 	if(hasWiFi == false){
 		reconnectionsCount++;
 		hasWiFi = true;
-		mqttTimeout.disable(); // ignore timeout in first connection
+		mqttClient->backoff.reset(); // don't wait for backoff of old failures
 		Logger.debug("WiFi - Reconnected", reconnectionsCount);
 		Logger.debug("Got IP", WiFi.localIP());
 	}
 
 
 	// Reconnect MQTT if OFFLINE and not have Client (TcpServer)
-	if (!mqtt.connected() && (mqttTimeout.expired() || !mqttTimeout.isEnabled()) && !WifiConnection::client.connected()) {
+	if (!WifiConnection::client.connected()) {
 		if (hasWiFi || WiFi.getMode() == WIFI_AP) {
-			mqttConnect();
+			mqttClient->reconnect();
 		}
 	}
 
 	if (mqtt.connected()) {
 		Config.keepAlive = false; // on MQTT is not required
 		connected = true;
+		payload = NULL;
 		mqtt.loop();
-		mqttTimeout.disable();
 		setStream(mqttClient);
-		return DeviceConnection::checkDataAvalible();
+		return parsePayload();
 	} else { // TCP SERVER...
-		if (!mqttTimeout.isEnabled())
-			mqttTimeout.enable();
 		Config.keepAlive = true; // on raw TCP is  required
 		connected = false;
 		return WifiConnection::checkDataAvalible();
@@ -81,35 +81,47 @@ bool MQTTWifiConnection::checkDataAvalible(void){
 
 }
 
-void MQTTWifiConnection::mqttCallback(char* topic, byte* payload, unsigned int length){
-	mqttClient->setData(payload, length);
+/**
+ * Keep only the location of the message, it is parsed by checkDataAvalible after mqtt.loop().
+ * If older messages are still waiting, it is queued after them.
+ */
+void MQTTWifiConnection::mqttCallback(char* topic, byte* data, unsigned int length){
+	if(!inbox.isEmpty()){
+		inbox.push(data, length);
+	}else{
+		payload = data;
+		payloadLength = length;
+	}
 }
 
-void MQTTWifiConnection::mqttConnect(){
+/**
+ * Parse next command of received messages, a message can have several commands.
+ * The last message is parsed in PubSubClient buffer, what can't wait there is moved to the inbox.
+ */
+bool MQTTWifiConnection::parsePayload(){
 
-	if (WiFi.status() != WL_CONNECTED) {
-		return;
+	#if DEBUG_CON
+	if(payload){
+		Serial.print("MQTT RECV: ");
+		Serial.write(payload, payloadLength);
+		Serial.println();
 	}
+	#endif
 
-	String clientID = String(Config.appID);
-	clientID+= "/";
-	clientID+= Config.moduleName;
-
-	String subscribe = String(Config.appID);
-	subscribe+= "/in/";
-	subscribe+= Config.moduleName;
+	bool received = inbox.parse(*this, payload, payloadLength);
+	payload = NULL;
+	return received;
+}
 
-	Logger.debug("MQTT", "Connecting... ");
+#if(ENABLE_STATE_TOPICS)
+bool MQTTWifiConnection::sendState(const char *name, value_t value, uint8_t decimals){
+	return mqttClient->publishState(name, value, decimals);
+}
+#endif
 
-	// Attempt to connect
-	if (mqtt.connect(clientID.c_str(), Config.appID, "*")) {
-	  Logger.debug("MQTT", "[connected]");
-	  mqtt.subscribe(subscribe.c_str());
-	} else {
-	  Logger.debug("MQTT <Fail>", mqtt.state());
-	  mqttTimeout.reset();
-	}
-	
+/** Messages are published on ACK_BIT, so only ASCII frames are supported */
+bool MQTTWifiConnection::acceptFrameFormat(uint8_t format){
+	return format == FrameFormat::ASCII;
 }
 
 } /* namespace od */
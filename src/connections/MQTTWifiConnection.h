@@ -26,10 +26,10 @@
 // NOTE: Please do not include OpenDevice.h this will break the preprocessors / macros
 #include "config.h"
 #include "utility/Logger.h"
-#include "utility/Timeout.h"
 #include "DeviceConnection.h"
 #include "WifiConnection.h"
 #include "MQTTClient.h"
+#include "utility/MessageQueue.h"
 
 
 namespace od {
@@ -38,6 +38,13 @@ class MQTTWifiConnection : public WifiConnection {
 
 static MQTTClient* mqttClient;
 
+// Last message received, parsed directly from PubSubClient buffer (valid until next mqtt.loop/publish)
+static const uint8_t* payload;
+static uint16_t payloadLength;
+
+// Messages (or the rest of them) that can't wait in PubSubClient buffer
+static MessageQueue inbox;
+
 public:
 	MQTTWifiConnection();
 
@@ -48,12 +55,23 @@ public:
 
 	virtual bool checkDataAvalible(void);
 
+	virtual bool acceptFrameFormat(uint8_t format);
+
+#if(ENABLE_STATE_TOPICS)
+	virtual bool sendState(const char *name, value_t value, uint8_t decimals);
+#endif
+
 	static void mqttCallback(char* topic, byte* payload, unsigned int length);
 
+	/** TCP connections opened to broker */
+	uint16_t connectAttempts() { return mqttClient->connectAttempts; }
+
+	/** Time (ms) without connection to broker */
+	uint32_t offlineTime() { return mqttClient->offlineTime(); }
+
 private:
 
 	PubSubClient mqtt;
-	Timeout mqttTimeout;
 
 #if defined(_YUN_SERVER_H_)
 YunClient ethclient;
@@ -70,7 +88,7 @@ YunClient ethclient;
 #endif
 #endif
 
-	void mqttConnect();
+	bool parsePayload();
 
 };
 
@@ -96,6 +96,7 @@ bool WifiConnetionEspAT::checkDataAvalible(void){
 
 		for (int i = 0 ; i < len; i++){
 			store(_buffer[i]);
+			decode(_buffer[i]);
 		}
 
 		clientID = mux_id;
@@ -110,8 +111,7 @@ bool WifiConnetionEspAT::checkDataAvalible(void){
 			Serial.print("\r\n");
 		#endif
 
-		uint8_t type = parseInt();
-		parseCommand(type);
+		parseCommand();
 		flush();
 
 //		setStream(&client);
@@ -241,7 +241,8 @@ void WifiConnetionEspAT::doStart(){
 
 void WifiConnetionEspAT::doEnd(){
 	Serial.print(">>");
-	Serial.println((char*)_buffer);
+	Serial.write(_buffer, _endOffset);
+	Serial.println();
 
 	write('\n');write('\r');
 	ESP->send(clientID, (uint8_t*)_buffer, _endOffset);
@@ -253,6 +254,11 @@ size_t WifiConnetionEspAT::write(uint8_t b){
 	store(b);
 }
 
+/** Data is sent by ESP AT firmware in doEnd(), so only ASCII frames are supported */
+bool WifiConnetionEspAT::acceptFrameFormat(uint8_t format){
+	return format == FrameFormat::ASCII;
+}
+
 WifiConnetionEspAT WiFi;
 
 #endif
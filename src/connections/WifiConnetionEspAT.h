@@ -66,6 +66,8 @@ public:
 
 	virtual size_t write(uint8_t);
 
+	virtual bool acceptFrameFormat(uint8_t format);
+
 	virtual void doStart();
 
 	virtual void doEnd();
@@ -39,38 +39,36 @@ void IRDevice::deserializeExtraData(Command *cmd, DeviceConnection *conn){
 
 	int protocol = conn->readInt();
 	/*debug*/if(debug) printf("protocol = %d \n", protocol);
-	int labels[10]= {0};
-	int length = conn->readIntValues(labels,10);
-	/*debug*/if(debug) printf("Labels(%d) : " , length);
-	for (int i = 0; i < length; ++i) {
+
+	// Labels are the distinct timings, values are letters (A = first label) read in place
+	unsigned int labels[10] = {0};
+	uint8_t labelsLength = 0;
+	long label;
+	Slice list = conn->readList();
+	while (labelsLength < 10 && list.nextInt(label)) {
+		labels[labelsLength++] = label;
+	}
+	/*debug*/if(debug) printf("Labels(%d) : " , labelsLength);
+	for (int i = 0; i < labelsLength; ++i) {
 		if(debug) printf("%d,", labels[i]);
 	}
 	if(debug) printf("\n");
 
-//	char *values;
-//	length = conn->readString(&values);
-	String values = conn->readString();
-	if(debug) printf("Values (%d) : %s\n", length, values.c_str());
+	Slice values = conn->readSlice();
+	if(debug) printf("Values (%d) : %.*s\n", values.length, (int) values.length, values.data);
 
-	unsigned int rawvalues[length];
+	unsigned int rawvalues[values.length];
 
-//	Serial.print("DB:");
-
-	for (int i = 0; i < length; ++i) {
-		int val = values[i];
-		int label = (val - 65); // convert to int
-		rawvalues[i] = labels[label];
+	for (int i = 0; i < values.length; ++i) {
+		uint8_t index = (values[i] - 65); // convert to int
+		rawvalues[i] = (index < labelsLength ? labels[index] : 0);
 		if(debug) printf("%d,", rawvalues[i]);
-//		Serial.print(rawvalues[i], 10);
-//		Serial.print(',');
 	}
 
 	if(debug) printf("\n");
 
-//	Serial.write(ACK_BIT);
-
 #ifndef DEBUG_ON_PC
-	irsend.sendRaw(rawvalues,length,32);
+	irsend.sendRaw(rawvalues,values.length,32);
 #endif
 
 }
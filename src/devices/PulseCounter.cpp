@@ -44,7 +44,7 @@ bool PulseCounter::hasChanged(){
 
 bool PulseCounter::setValue(value_t value, bool sync){
 	currentValue = value;
-	count = value; // restore previous value
+	count = (uint32_t) value; // restore previous value
 	return true;
 }
 
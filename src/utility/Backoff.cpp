@@ -0,0 +1,42 @@
+/*
+ * Backoff.cpp
+ *
+ *  Randomized exponential backoff, used to space reconnection attempts.
+ */
+
+#include "Backoff.h"
+
+namespace od {
+
+Backoff::Backoff(uint32_t minDelay, uint32_t maxDelay) : _min(minDelay), _max(maxDelay), _wait(0), _start(0), _failures(0), _random(2463534242UL) {
+
+}
+
+bool Backoff::ready(){
+	return millis() - _start >= _wait;
+}
+
+void Backoff::fail(){
+	if(_failures < 255) _failures++;
+
+	uint32_t limit = _max;
+	if(_failures < 16 && (_min << _failures) < _max) limit = _min << _failures;
+
+	_wait = limit / 2 + next(limit / 2 + 1);
+	_start = millis();
+}
+
+void Backoff::reset(){
+	_failures = 0;
+	_wait = next(_min + 1);
+	_start = millis();
+}
+
+uint32_t Backoff::next(uint32_t limit){
+	_random ^= _random << 13;
+	_random ^= _random >> 17;
+	_random ^= _random << 5;
+	return _random % limit;
+}
+
+} /* namespace od */
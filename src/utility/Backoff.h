@@ -0,0 +1,43 @@
+/*
+ * Backoff.h
+ *
+ *  Randomized exponential backoff, used to space reconnection attempts.
+ */
+
+#ifndef LIBRARIES_OPENDEVICE_SRC_UTILITY_BACKOFF_H_
+#define LIBRARIES_OPENDEVICE_SRC_UTILITY_BACKOFF_H_
+
+
+#include <Arduino.h>
+
+namespace od {
+
+/**
+ * Each failure doubles the wait (from 'minDelay' up to 'maxDelay') and the wait is randomized
+ * between half and all of it, so devices that lost the server at the same time don't retry together.
+ */
+class Backoff {
+public:
+	Backoff(uint32_t minDelay, uint32_t maxDelay);
+	/** Wait is over, try again */
+	bool ready();
+	/** Attempt failed, wait longer */
+	void fail();
+	/** Start again with a short (random, up to 'minDelay') wait */
+	void reset();
+	uint8_t failures() { return _failures; }
+	/** Make random waits unique to this device (like a hash of its name) */
+	void seed(uint32_t seed) { if(seed) _random = seed; }
+private:
+	uint32_t next(uint32_t limit);
+	uint32_t _min;
+	uint32_t _max;
+	uint32_t _wait;
+	unsigned long _start;
+	uint8_t _failures;
+	uint32_t _random;  // xorshift state, doesn't change random() of sketch
+};
+
+} /* namespace od */
+
+#endif /* LIBRARIES_OPENDEVICE_SRC_UTILITY_BACKOFF_H_ */
@@ -0,0 +1,80 @@
+/*
+ * ******************************************************************************
+ *  Copyright (c) 2013-2014 CriativaSoft (www.criativasoft.com.br)
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *  Ricardo JL Rufino - Initial API and Implementation
+ * *****************************************************************************
+ */
+
+#ifndef Fixed_h
+#define Fixed_h
+
+#include <Arduino.h>
+
+/**
+ * Q16.16 fixed point number (16 bits integer part, 16 bits fraction), used as value_t when
+ * VALUE_TYPE is VALUE_FIXED. Arithmetic and comparisons use only integer instructions.
+ * Range is -32768 .. 32767.99998 with steps of 1/65536, values out of range wrap around.
+ *
+ * Numbers are converted to Fixed implicitly, conversions from Fixed must be explicit: (long) value, (float) value.
+ */
+class Fixed {
+
+public:
+
+	static const uint8_t FRACTION_BITS = 16;
+	static const int32_t ONE = (int32_t) 1 << FRACTION_BITS;
+
+	int32_t raw;
+
+	Fixed() : raw(0) {}
+	Fixed(int value) : raw((int32_t) value * ONE) {}
+	Fixed(unsigned int value) : raw((int32_t) value * ONE) {}
+	Fixed(long value) : raw((int32_t) value * ONE) {}
+	Fixed(unsigned long value) : raw((int32_t) value * ONE) {}
+	Fixed(float value) : raw((int32_t) (value * ONE + (value < 0 ? -0.5f : 0.5f))) {}
+	Fixed(double value) : raw((int32_t) (value * ONE + (value < 0 ? -0.5 : 0.5))) {}
+
+	static Fixed fromRaw(int32_t raw) { Fixed f; f.raw = raw; return f; }
+
+	/** Integer part, truncated toward zero like a cast of float */
+	long toLong() const { return raw < 0 ? -(long) (-raw >> FRACTION_BITS) : (long) (raw >> FRACTION_BITS); }
+
+	explicit operator bool() const { return raw != 0; }
+
+	/** Integer types are converted without floating point (the branch is removed by compiler) */
+	template <class T> explicit operator T() const {
+		return ((T) 0.5 != 0) ? (T) ((double) raw / ONE) : (T) toLong();
+	}
+
+	Fixed operator-() const { return fromRaw(-raw); }
+	bool operator!() const { return raw == 0; }
+
+	Fixed& operator+=(const Fixed& other) { raw += other.raw; return *this; }
+	Fixed& operator-=(const Fixed& other) { raw -= other.raw; return *this; }
+	Fixed& operator*=(const Fixed& other) { raw = (int32_t) (((int64_t) raw * other.raw) >> FRACTION_BITS); return *this; }
+	Fixed& operator/=(const Fixed& other) { raw = other.raw ? (int32_t) (((int64_t) raw << FRACTION_BITS) / other.raw) : 0; return *this; }
+	Fixed& operator++() { raw += ONE; return *this; }
+	Fixed operator++(int) { Fixed old = *this; raw += ONE; return old; }
+	Fixed& operator--() { raw -= ONE; return *this; }
+	Fixed operator--(int) { Fixed old = *this; raw -= ONE; return old; }
+
+	friend Fixed operator+(Fixed a, const Fixed& b) { return a += b; }
+	friend Fixed operator-(Fixed a, const Fixed& b) { return a -= b; }
+	friend Fixed operator*(Fixed a, const Fixed& b) { return a *= b; }
+	friend Fixed operator/(Fixed a, const Fixed& b) { return a /= b; }
+
+	friend bool operator==(const Fixed& a, const Fixed& b) { return a.raw == b.raw; }
+	friend bool operator!=(const Fixed& a, const Fixed& b) { return a.raw != b.raw; }
+	friend bool operator<(const Fixed& a, const Fixed& b) { return a.raw < b.raw; }
+	friend bool operator>(const Fixed& a, const Fixed& b) { return a.raw > b.raw; }
+	friend bool operator<=(const Fixed& a, const Fixed& b) { return a.raw <= b.raw; }
+	friend bool operator>=(const Fixed& a, const Fixed& b) { return a.raw >= b.raw; }
+};
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ * ******************************************************************************
+ *  Copyright (c) 2013-2014 CriativaSoft (www.criativasoft.com.br)
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *  Ricardo JL Rufino - Initial API and Implementation
+ * *****************************************************************************
+ */
+
+#include "LoopProfiler.h"
+
+LoopProfiler::LoopProfiler() {
+	reset();
+}
+
+void LoopProfiler::reset(){
+	memset(_min, 0xFF, sizeof(_min));
+	memset(_max, 0, sizeof(_max));
+	memset(_sum, 0, sizeof(_sum));
+	memset(_count, 0, sizeof(_count));
+	memset(_buckets, 0, sizeof(_buckets));
+}
+
+void LoopProfiler::add(uint8_t stage, uint32_t time){
+	if(stage >= LoopStage::COUNT) return;
+
+	if(_count[stage] == 0xFFFF || _sum[stage] > 0xFFFFFFFF - time) decay(stage);
+
+	uint8_t bucket = 0;
+	while (bucket < PROFILER_BUCKETS - 1 && (time >> bucket)) bucket++;
+
+	if(time < _min[stage]) _min[stage] = time;
+	if(time > _max[stage]) _max[stage] = time;
+	_sum[stage] += time;
+	_count[stage]++;
+	_buckets[stage][bucket]++;
+}
+
+void LoopProfiler::decay(uint8_t stage){
+	_sum[stage] /= 2;
+	_count[stage] /= 2;
+	for (uint8_t i = 0; i < PROFILER_BUCKETS; ++i) {
+		_buckets[stage][i] /= 2;
+	}
+}
+
+uint32_t LoopProfiler::p99(uint8_t stage){
+	uint16_t total = 0;
+	for (uint8_t i = 0; i < PROFILER_BUCKETS; ++i) total += _buckets[stage][i];
+	if(total == 0) return 0;
+
+	uint16_t target = total - total / 100; // samples at or below p99
+	uint16_t seen = 0;
+	for (uint8_t i = 0; i < PROFILER_BUCKETS - 1; ++i) {
+		seen += _buckets[stage][i];
+		if(seen >= target) return i == 0 ? 0 : (1UL << i) - 1;
+	}
+
+	return _max[stage];
+}
+
+void LoopProfiler::print(uint8_t stage, Print &out){
+	out.print(name(stage));
+	out.print(',');
+	out.print(count(stage));
+	out.print(',');
+	out.print(minimum(stage));
+	out.print(',');
+	out.print(average(stage));
+	out.print(',');
+	out.print(maximum(stage));
+	out.print(',');
+	out.print(p99(stage));
+}
+
+const char* LoopProfiler::name(uint8_t stage){
+	switch (stage) {
+	case LoopStage::LOOP: return "loop";
+	case LoopStage::RECEIVE: return "receive";
+	case LoopStage::DISPATCH: return "dispatch";
+	case LoopStage::SENSORS: return "sensors";
+	case LoopStage::SEND: return "send";
+	case LoopStage::SCHEDULER: return "scheduler";
+	case LoopStage::REMOTE_UPDATE: return "ota";
+	case LoopStage::ALEXA: return "alexa";
+	case LoopStage::SAVE: return "save";
+	default:
+		return "";
+	}
+}
@@ -0,0 +1,74 @@
+/*
+ * ******************************************************************************
+ *  Copyright (c) 2013-2014 CriativaSoft (www.criativasoft.com.br)
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *  Ricardo JL Rufino - Initial API and Implementation
+ * *****************************************************************************
+ */
+
+#ifndef LoopProfiler_h
+#define LoopProfiler_h
+
+#include <Arduino.h>
+#include "config.h"
+
+#define PROFILER_BUCKETS 16 // bucket N: time (us) with N significant bits, last one is everything above
+
+/** Stages of OpenDeviceClass::loop() measured by LoopProfiler */
+namespace LoopStage {
+	enum LoopStage {
+		LOOP 			= 0, // whole loop() pass
+		RECEIVE 		= 1, // checkDataAvalible()
+		DISPATCH 		= 2, // onMessageReceivedImpl()
+		SENSORS 		= 3, // checkSensorsStatus()
+		SEND 			= 4, // sendPendingValues() / drainTx()
+		SCHEDULER 		= 5, // scheduler.execute()
+		REMOTE_UPDATE 	= 6, // RemoteUpdate.check()
+		ALEXA 			= 7, // Alexa.loop()
+		SAVE 			= 8, // save devices state (config)
+		COUNT 			= 9
+	};
+}
+
+/**
+ * Records time spent in each LoopStage in log-scale histograms (fixed size, no allocation).
+ * When a counter is about to overflow all values of the stage are halved, so old samples lose weight.
+ */
+class LoopProfiler {
+public:
+	LoopProfiler();
+
+	/** Record 'time' (us) spent in stage */
+	void add(uint8_t stage, uint32_t time);
+
+	void reset();
+
+	uint16_t count(uint8_t stage) { return _count[stage]; }
+	uint32_t minimum(uint8_t stage) { return _count[stage] ? _min[stage] : 0; }
+	uint32_t maximum(uint8_t stage) { return _max[stage]; }
+	uint32_t average(uint8_t stage) { return _count[stage] ? _sum[stage] / _count[stage] : 0; }
+
+	/** Upper bound (us) of the bucket that has the 99th percentile */
+	uint32_t p99(uint8_t stage);
+
+	/** Print: name,count,min,avg,max,p99 */
+	void print(uint8_t stage, Print &out);
+
+	static const char* name(uint8_t stage);
+
+private:
+	uint32_t _min[LoopStage::COUNT];
+	uint32_t _max[LoopStage::COUNT];
+	uint32_t _sum[LoopStage::COUNT];
+	uint16_t _count[LoopStage::COUNT];
+	uint16_t _buckets[LoopStage::COUNT][PROFILER_BUCKETS];
+
+	void decay(uint8_t stage);
+};
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * ******************************************************************************
+ *  Copyright (c) 2013-2014 CriativaSoft (www.criativasoft.com.br)
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *  Ricardo JL Rufino - Initial API and Implementation
+ * *****************************************************************************
+ */
+
+#ifndef MessageQueue_h
+#define MessageQueue_h
+
+#include <Arduino.h>
+#include "config.h"
+#include "DeviceConnection.h"
+
+/**
+ * Ring of received messages (MQTT payloads) waiting to be parsed, stored one after another.
+ * Commands end with ACK_BIT, so messages don't need a length: the queue is read like a stream,
+ * in contiguous blocks (peek/skip) that are given to DeviceConnection::parse.
+ *
+ * A new message is parsed in place (PubSubClient buffer) when nothing is waiting before it.
+ * That buffer is also used to publish responses, and a response can be sent while a command is
+ * parsed (errors, DISCOVERY_REQUEST, listeners), so the rest of the message is copied before.
+ */
+class MessageQueue {
+
+public:
+
+	MessageQueue() : dropped(0), head(0), length(0) {}
+
+	/** Add a message. Return false if there is no room for all of it (message is discarded) */
+	bool push(const uint8_t *data, uint16_t size) {
+		if (size > MQTT_INBOX - length) {
+			dropped++;
+			return false;
+		}
+		uint16_t tail = (head + length) % MQTT_INBOX;
+		uint16_t first = MQTT_INBOX - tail;
+		if (first > size) first = size;
+		memcpy(&buffer[tail], data, first);
+		memcpy(buffer, data + first, size - first);
+		length += size;
+		return true;
+	}
+
+	/** Point 'data' to the next bytes. Return how many can be read there (0 if empty) */
+	uint16_t peek(const uint8_t *&data) {
+		data = &buffer[head];
+		uint16_t size = MQTT_INBOX - head;
+		return (size < length ? size : length);
+	}
+
+	/** Remove 'size' bytes read with peek */
+	void skip(uint16_t size) {
+		head = (head + size) % MQTT_INBOX;
+		length -= size;
+		if (length == 0) head = 0;
+	}
+
+	bool isEmpty() { return length == 0; }
+
+	/**
+	 * Parse next command of the waiting messages or of 'message' (new message, NULL if none), that is
+	 * queued as needed: it must not be used after this call. Return true if a command was received.
+	 */
+	bool parse(DeviceConnection &conn, const uint8_t *message, uint16_t size) {
+		bool received = false;
+
+		// Keep the order, new message goes after the waiting ones
+		if (message && !isEmpty()) {
+			push(message, size);
+			message = NULL;
+		}
+
+		const uint8_t *data;
+		uint16_t available;
+		while (!received && (available = peek(data)) > 0) {
+			skip(conn.parse(data, available, received));
+		}
+
+		if (message) {
+			// Commands after the first are copied before it can be dispatched
+			const uint8_t *ack = (const uint8_t *) memchr(message, Command::ACK_BIT, size);
+			uint16_t first = (ack ? ack - message + 1 : size);
+			if (first < size) push(message + first, size - first);
+
+			// If the first command fails, what is left of it is discarded (buffer may have the error response)
+			conn.parse(message, first, received);
+		}
+
+		return received;
+	}
+
+	/** Messages discarded because the queue was full */
+	uint16_t dropped;
+
+private:
+	uint8_t buffer[MQTT_INBOX > 0 ? MQTT_INBOX : 1];
+	uint16_t head;
+	uint16_t length;
+};
+
+#endif
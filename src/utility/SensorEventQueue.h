@@ -0,0 +1,77 @@
+/*
+ * ******************************************************************************
+ *  Copyright (c) 2013-2014 CriativaSoft (www.criativasoft.com.br)
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *  Ricardo JL Rufino - Initial API and Implementation
+ * *****************************************************************************
+ */
+
+#ifndef SensorEventQueue_h
+#define SensorEventQueue_h
+
+#include <Arduino.h>
+#include "config.h"
+
+/** Value of SensorEvent when sensor can't be read inside the interrupt (analog, IOExtender) */
+#define SENSOR_EVENT_UNREAD -1
+
+/** Change of an interrupt sensor, captured by OpenDeviceClass::onInterruptReceived */
+struct SensorEvent {
+	uint8_t position;   // position of sensor in OpenDevice devices
+	int8_t value;       // pin level or SENSOR_EVENT_UNREAD
+	uint32_t time;      // millis() of the interrupt
+};
+
+/**
+ * Single producer (interrupt) / single consumer (loop) ring of SensorEvent.
+ * No locks are needed: 'head' is only written by push() and 'tail' only by pop(), both are single bytes.
+ * Each edge is kept until loop() handles it, so fast bursts are not lost while the queue has room.
+ */
+class SensorEventQueue {
+
+public:
+
+	SensorEventQueue() : overflows(0), head(0), tail(0) {}
+
+	/** Called from interrupt. Return false if the queue is full (event is discarded) */
+	inline bool push(uint8_t position, int8_t value, uint32_t time) {
+		uint8_t next = (head + 1) & (SENSOR_EVENT_QUEUE - 1);
+		if (next == tail) {
+			overflows++;
+			return false;
+		}
+		events[head].position = position;
+		events[head].value = value;
+		events[head].time = time;
+		head = next; // publish after event is written
+		return true;
+	}
+
+	/** Called from loop. Return false if there are no events */
+	inline bool pop(SensorEvent &event) {
+		uint8_t current = tail;
+		if (current == head) return false;
+		event.position = events[current].position;
+		event.value = events[current].value;
+		event.time = events[current].time;
+		tail = (current + 1) & (SENSOR_EVENT_QUEUE - 1);
+		return true;
+	}
+
+	inline bool isEmpty() { return head == tail; }
+
+	/** Events discarded because the queue was full */
+	volatile uint16_t overflows;
+
+private:
+	volatile SensorEvent events[SENSOR_EVENT_QUEUE];
+	volatile uint8_t head;
+	volatile uint8_t tail;
+};
+
+#endif
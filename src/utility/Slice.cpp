@@ -0,0 +1,166 @@
+/*
+ * ******************************************************************************
+ *  Copyright (c) 2013-2014 CriativaSoft (www.criativasoft.com.br)
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *  Ricardo JL Rufino - Initial API and Implementation
+ * *****************************************************************************
+ */
+
+#include "Slice.h"
+#include "Command.h"
+
+static inline bool isDigit(char c){
+	return c >= '0' && c <= '9';
+}
+
+static inline bool isListEnd(char c){
+	return  c==']' || c==')' || c=='}' || c==Command::SEPARATOR;
+}
+
+bool Slice::equals(const char *str) const {
+	return strncmp(data, str, length) == 0 && str[length] == '\0';
+}
+
+bool Slice::equals(const char *str, uint16_t size) const {
+	uint16_t n = (length < size ? length : size);
+	return strncmp(data, str, n) == 0 && (n == size || str[n] == '\0');
+}
+
+bool Slice::nextInt(long &value){
+	// ignore non numeric leading characters
+	while (length > 0 && *data != '-' && !isDigit(*data)) { data++; length--; }
+
+	if(length == 0) return false;
+
+	bool isNegative = (*data == '-');
+	if(isNegative){ data++; length--; }
+
+	value = 0;
+
+#if ENABLE_SWAR_DECODER
+	// Four digits per step: all bytes of the word must be in '0'..'9' (high nibble 3, low nibble <= 9)
+	while (length >= 4) {
+		uint32_t word;
+		memcpy(&word, data, 4);
+		if ((word & 0xF0F0F0F0) != 0x30303030 || ((word + 0x06060606) & 0xF0F0F0F0) != 0x30303030) break;
+		word -= 0x30303030;
+		word = (word * 10 + (word >> 8)) & 0x00FF00FF; // pairs: d0d1, d2d3 (little endian)
+		value = value * 10000 + (word & 0xFF) * 100 + (word >> 16);
+		data += 4; length -= 4;
+	}
+#endif
+
+	while (length > 0 && isDigit(*data)) {
+		value = value * 10 + *data - '0';
+		data++; length--;
+	}
+
+	if(isNegative) value = -value;
+	return true;
+}
+
+bool Slice::nextFloat(float &value){
+	// ignore non numeric leading characters
+	while (length > 0 && *data != '-' && *data != '.' && !isDigit(*data)) { data++; length--; }
+
+	if(length == 0) return false;
+
+	bool isNegative = (*data == '-');
+	if(isNegative){ data++; length--; }
+
+	long integer = 0;
+	float fraction = 1.0;
+	bool isFraction = false;
+
+	while (length > 0 && (isDigit(*data) || (*data == '.' && !isFraction))) {
+		if(*data == '.'){
+			isFraction = true;
+		}else{
+			integer = integer * 10 + *data - '0';
+			if(isFraction) fraction *= 0.1;
+		}
+		data++; length--;
+	}
+
+	value = (isFraction ? integer * fraction : integer);
+	if(isNegative) value = -value;
+	return true;
+}
+
+long Slice::toInt() const {
+	long value = 0;
+	Slice cursor = *this;
+	cursor.nextInt(value);
+	return value;
+}
+
+float Slice::toFloat() const {
+	float value = 0;
+	Slice cursor = *this;
+	cursor.nextFloat(value);
+	return value;
+}
+
+int Slice::toArray(int values[], int max) const {
+	int size = 0;
+	long value;
+	Slice cursor = *this;
+	while (size < max && cursor.nextInt(value)) values[size++] = value;
+	return size;
+}
+
+int Slice::toArray(long values[], int max) const {
+	int size = 0;
+	Slice cursor = *this;
+	while (size < max && cursor.nextInt(values[size])) size++;
+	return size;
+}
+
+int Slice::toArray(float values[], int max) const {
+	int size = 0;
+	Slice cursor = *this;
+	while (size < max && cursor.nextFloat(values[size])) size++;
+	return size;
+}
+
+Slice Slice::token(const uint8_t *buffer, uint16_t &offset, uint16_t end){
+	if(offset < end && (buffer[offset] == Command::SEPARATOR || buffer[offset] == ',')) offset++; // skip first
+
+	uint16_t start = offset;
+
+	while (offset < end && buffer[offset] != Command::SEPARATOR && buffer[offset] != ',') {
+		offset++;
+	}
+
+	Slice slice = { (const char *) &buffer[start], (uint16_t) (offset - start) };
+
+	if(offset < end) offset++; // skip separator
+
+	return slice;
+}
+
+Slice Slice::list(const uint8_t *buffer, uint16_t &offset, uint16_t end){
+	while (offset < end && (buffer[offset] == Command::SEPARATOR || buffer[offset] == ';'
+			|| buffer[offset] == '[' || buffer[offset] == '(' || buffer[offset] == '{')) {
+		offset++;
+	}
+
+	uint16_t start = offset;
+
+	while (offset < end && !isListEnd(buffer[offset])) {
+		offset++;
+	}
+
+	Slice slice = { (const char *) &buffer[start], (uint16_t) (offset - start) };
+
+	// skip separator '];'
+	if(offset < end && buffer[offset] != Command::SEPARATOR) offset++;
+	if(offset < end && (buffer[offset] == Command::SEPARATOR || buffer[offset] == ';')) offset++;
+
+	return slice;
+}
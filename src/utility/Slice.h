@@ -0,0 +1,55 @@
+/*
+ * ******************************************************************************
+ *  Copyright (c) 2013-2014 CriativaSoft (www.criativasoft.com.br)
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *  Ricardo JL Rufino - Initial API and Implementation
+ * *****************************************************************************
+ */
+
+#ifndef Slice_h
+#define Slice_h
+
+#include <Arduino.h>
+#include "config.h"
+
+/**
+ * View of part of a receive buffer (nothing is copied), valid until the buffer is flushed.
+ * Also works as a cursor: nextInt/nextFloat consume the values from the start of the slice.
+ * Ex: Slice list = conn->readList(); long v; while(list.nextInt(v)){ ... }
+ */
+struct Slice {
+	const char *data;
+	uint16_t length;
+
+	bool isEmpty() const { return length == 0; }
+	char operator[](uint16_t i) const { return data[i]; }
+	bool equals(const char *str) const;
+
+	/** Compare only the first 'size' chars, with 'str' like a char[size] filled by strncpy (may not end with '\0') */
+	bool equals(const char *str, uint16_t size) const;
+
+	/** Decode next integer, skipping separators. Return false when there are no more values */
+	bool nextInt(long &value);
+	bool nextFloat(float &value);
+
+	long toInt() const;
+	float toFloat() const;
+
+	/** Decode all values of a list (see: list) in a single pass, returns the number of values */
+	int toArray(int values[], int max) const;
+	int toArray(long values[], int max) const;
+	int toArray(float values[], int max) const;
+
+	/** Token at 'offset' delimited by '/' or ',' (skip first delimiter). Offset is moved after the token */
+	static Slice token(const uint8_t *buffer, uint16_t &offset, uint16_t end);
+
+	/** Values of list like: [1,2,3];  at 'offset'. Offset is moved after the list */
+	static Slice list(const uint8_t *buffer, uint16_t &offset, uint16_t end);
+};
+
+#endif
@@ -0,0 +1,175 @@
+/*
+ * ******************************************************************************
+ *  Copyright (c) 2013-2014 CriativaSoft (www.criativasoft.com.br)
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *  Ricardo JL Rufino - Initial API and Implementation
+ * *****************************************************************************
+ */
+
+#include "StateLog.h"
+
+// CRC-8 (polynomial 0x07) of records
+static uint8_t crc8(uint8_t crc, uint8_t data){
+	crc ^= data;
+	for (uint8_t i = 0; i < 8; i++) {
+		crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+	}
+	return crc;
+}
+
+// Sequence 'a' was written after 'b' (counter wraps around)
+static inline bool newer(uint16_t a, uint16_t b){
+	return (int16_t) (a - b) > 0;
+}
+
+StateLog::StateLog(uint16_t start, uint16_t size) :
+		_start(start),
+		_slots(size / RECORD_SIZE > 255 ? 255 : size / RECORD_SIZE),
+		_head(0),
+		_sequence(0){
+	memset(_latest, 0, sizeof(_latest));
+}
+
+void StateLog::load(uint8_t state[], uint16_t length){
+
+	Record record;
+	uint16_t latestSequence[DEVICES_STATE_SIZE];
+	bool found = false;
+
+	memset(_latest, 0, sizeof(_latest));
+	_sequence = 0;
+	_head = 0;
+
+	if (_slots == 0) return; // no log (STATE_LOG_SIZE 0)
+
+	// Newest record of each offset and of all, the ring continues after it
+	uint16_t newest = 0;
+	for (uint16_t slot = 0; slot < _slots; slot++) {
+		if (!readRecord(slot, record)) continue;
+
+		if (!_latest[record.offset] || newer(record.sequence, latestSequence[record.offset])) {
+			latestSequence[record.offset] = record.sequence;
+			_latest[record.offset] = slot + 1;
+		}
+
+		if (!found || newer(record.sequence, newest)) {
+			newest = record.sequence;
+			_head = (slot + 1) % _slots;
+			found = true;
+		}
+	}
+
+	_sequence = newest;
+
+	if (!state) return;
+
+	for (uint16_t offset = 0; offset < DEVICES_STATE_SIZE; offset++) {
+		if (_latest[offset] && readRecord(_latest[offset] - 1, record) && offset + record.size <= length) {
+			memcpy(state + offset, record.data, record.size);
+		}
+	}
+}
+
+void StateLog::clear(){
+
+	Record record;
+
+	for (uint16_t slot = 0; slot < _slots; slot++) {
+		if (readRecord(slot, record)) write(_start + slot * RECORD_SIZE + 3, 0); // invalid size
+	}
+
+	memset(_latest, 0, sizeof(_latest));
+}
+
+bool StateLog::append(uint8_t offset, const uint8_t *data, uint8_t size){
+
+	Record record;
+
+	if (_slots == 0) return false; // no log, state is saved with the configuration
+
+	// Record at head is the last of its offset: copy it to a free slot before head is written,
+	// a reset while a record is written must not lose the only copy of a value
+	if (readRecord(_head, record) && _latest[record.offset] == _head + 1) {
+		uint16_t spare = _head;
+		for (uint16_t i = 1; i < _slots && spare == _head; i++) {
+			uint16_t slot = (_head + i) % _slots;
+			if (!isLatest(slot)) spare = slot;
+		}
+
+		if (spare == _head) return false;
+
+		// Same offset, the new record takes the free slot and the one at head is obsolete
+		if (record.offset == offset) {
+			writeRecord(spare, offset, data, size);
+			return true;
+		}
+
+		writeRecord(spare, record.offset, record.data, record.size);
+	}
+
+	writeRecord(_head, offset, data, size);
+	_head = (_head + 1) % _slots;
+
+	return true;
+}
+
+bool StateLog::isLatest(uint16_t slot){
+	Record record;
+	return readRecord(slot, record) && _latest[record.offset] == slot + 1;
+}
+
+void StateLog::writeRecord(uint16_t slot, uint8_t offset, const uint8_t *data, uint8_t size){
+
+	_sequence++;
+
+	uint8_t bytes[RECORD_SIZE];
+	bytes[0] = _sequence & 0xFF;
+	bytes[1] = _sequence >> 8;
+	bytes[2] = offset;
+	bytes[3] = size;
+	memset(bytes + 4, 0, VALUE_SIZE);
+	memcpy(bytes + 4, data, size);
+
+	uint8_t crc = 0xFF;
+	for (uint8_t i = 0; i < RECORD_SIZE - 1; i++) crc = crc8(crc, bytes[i]);
+	bytes[RECORD_SIZE - 1] = crc;
+
+	uint16_t address = _start + slot * RECORD_SIZE;
+	for (uint8_t i = 0; i < RECORD_SIZE; i++) write(address + i, bytes[i]);
+
+	_latest[offset] = slot + 1;
+}
+
+bool StateLog::readRecord(uint16_t slot, Record &record){
+
+	uint8_t bytes[RECORD_SIZE];
+	uint16_t address = _start + slot * RECORD_SIZE;
+
+	uint8_t crc = 0xFF;
+	for (uint8_t i = 0; i < RECORD_SIZE; i++) {
+		bytes[i] = read(address + i);
+		if (i < RECORD_SIZE - 1) crc = crc8(crc, bytes[i]);
+	}
+
+	if (crc != bytes[RECORD_SIZE - 1]) return false;
+
+	record.sequence = bytes[0] | (bytes[1] << 8);
+	record.offset = bytes[2];
+	record.size = bytes[3];
+	memcpy(record.data, bytes + 4, VALUE_SIZE);
+
+	return record.size > 0 && record.size <= VALUE_SIZE && record.offset + record.size <= DEVICES_STATE_SIZE;
+}
+
+uint8_t StateLog::read(uint16_t address){
+	return EEPROM.read(address);
+}
+
+void StateLog::write(uint16_t address, uint8_t value){
+	if (EEPROM.read(address) != value) EEPROM.write(address, value);
+}
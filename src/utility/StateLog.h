@@ -0,0 +1,83 @@
+/*
+ * ******************************************************************************
+ *  Copyright (c) 2013-2014 CriativaSoft (www.criativasoft.com.br)
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *  Ricardo JL Rufino - Initial API and Implementation
+ * *****************************************************************************
+ */
+
+#ifndef StateLog_h
+#define StateLog_h
+
+#include <Arduino.h>
+#include "config.h"
+
+/**
+ * Wear-leveled log of device state changes in EEPROM (used by ConfigClass::saveState).
+ *
+ * Each record (sequence, offset, size, bytes, CRC8) is a change of some bytes of the packed
+ * ConfigClass::devicesState. Records are written one after another around a ring, so every
+ * cell of the area is written about once per lap, and there is no header or fixed position rewritten on each save.
+ * On load the newest valid record of each offset is applied, and the newest of all tells where the ring
+ * continues. Records with a bad CRC (interrupted write) are ignored.
+ *
+ * The last record of an offset is never overwritten: when the ring reaches it, it is first copied to a slot
+ * that has no last record (or the new change of the same offset goes there), so a reset during a write
+ * loses at most the change being written. The ring must have more records (capacity) than values being saved.
+ */
+class StateLog {
+
+public:
+
+	static const uint8_t VALUE_SIZE = 4; // max bytes of a change
+	static const uint8_t RECORD_SIZE = 2 + 1 + 1 + VALUE_SIZE + 1;
+
+	StateLog(uint16_t start, uint16_t size);
+	virtual ~StateLog() {}
+
+	/** Find the end of the ring and apply the last change of each offset to 'state' (if not NULL) */
+	void load(uint8_t state[], uint16_t length);
+
+	/** Invalidate all records (state saved elsewhere is newer) */
+	void clear();
+
+	/** Write a record of 'size' bytes (max VALUE_SIZE) changed at 'offset'. Return false if the ring has only last changes of offsets (or no slots) */
+	bool append(uint8_t offset, const uint8_t *data, uint8_t size);
+
+	/** Sequence of last record */
+	uint16_t sequence() { return _sequence; }
+
+	uint16_t capacity() { return _slots; }
+
+protected:
+
+	/** Storage access, EEPROM by default (can be changed to simulate the storage) */
+	virtual uint8_t read(uint16_t address);
+	virtual void write(uint16_t address, uint8_t value);
+
+private:
+
+	struct Record {
+		uint16_t sequence;
+		uint8_t offset;
+		uint8_t size;
+		uint8_t data[VALUE_SIZE];
+	};
+
+	uint16_t _start;
+	uint16_t _slots;
+	uint16_t _head;       // slot of next record
+	uint16_t _sequence;
+	uint8_t _latest[DEVICES_STATE_SIZE]; // slot + 1 of last record of each offset, 0 is none
+
+	bool readRecord(uint16_t slot, Record &record);
+	bool isLatest(uint16_t slot);
+	void writeRecord(uint16_t slot, uint8_t offset, const uint8_t *data, uint8_t size);
+};
+
+#endif
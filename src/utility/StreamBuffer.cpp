@@ -19,6 +19,10 @@ size_t StreamBuffer::write(uint8_t byte) {
 
 void StreamBuffer::flush() {
   memset(_buffer, 0, _len);
+  clear();
+}
+
+void StreamBuffer::clear() {
   _endOffset = 0;
   _readOffset = 0;
   _buffer_overflow = false;
@@ -50,56 +54,24 @@ int StreamBuffer::read(void)
   }
 }
 
-int StreamBuffer::readLongValues(long values[], int max){
-	int size = 0;
-	memset(values, 0, max);
-	int lastOffset = _endOffset;
-	_endOffset = nextEndOffSet();
-
-	while(available() && size < max){
-		values[size] = parseInt();
-		size++;
-	}
-
-	_readOffset+=2;// skip separator '];'
-	_endOffset = lastOffset;
+Slice StreamBuffer::readList(){
+	uint16_t offset = _readOffset;
+	Slice slice = Slice::list(_buffer, offset, _endOffset);
+	_readOffset = offset;
+	return slice;
+}
 
-	return size;
+int StreamBuffer::readLongValues(long values[], int max){
+	return readList().toArray(values, max);
 }
 
 int StreamBuffer::readIntValues(int values[], int max){
-	int size = 0;
-	memset(values, 0, max);
-	int lastOffset = _endOffset;
-	_endOffset = nextEndOffSet();
-
-	while(available() && size < max){
-		values[size] = parseInt();
-		size++;
-	}
-
-	_readOffset+=2;// skip separator '];'
-	_endOffset = lastOffset;
-
-	return size;
+	return readList().toArray(values, max);
 }
 
 int StreamBuffer::readFloatValues(float values[], int max)
 {
-	int size = 0;
-	memset(values, 0, max);
-	int lastOffset = _endOffset;
-	_endOffset = nextEndOffSet();
-
-	while(available() && size < max){
-		values[size] = parseFloat();
-		size++;
-	}
-
-	_readOffset+=2;// skip separator '];'
-	_endOffset = lastOffset;
-
-	return size;
+	return readList().toArray(values, max);
 }
 
 String StreamBuffer::readString()
@@ -116,17 +88,3 @@ String StreamBuffer::readString()
 	  }
 	  return ret;
 }
-
-int StreamBuffer::nextEndOffSet(){
-	int endOffset = _readOffset;
-	for(int end = _readOffset;end < _endOffset;end++){
-		if (isListEnd(_buffer[end]) && end != _readOffset) break;
-		endOffset++;
-	}
-
-	return endOffset;
-}
-
-bool StreamBuffer::isListEnd(char c){
-	return  c==']' || c==')' || c=='}' || c==Command::SEPARATOR;
-}
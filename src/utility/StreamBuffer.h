@@ -4,6 +4,7 @@
 #include <inttypes.h>
 #include <Stream.h>
 #include "Command.h"
+#include "Slice.h"
 
 class StreamBuffer : public Stream
 {
@@ -17,8 +18,6 @@ private:
 
    volatile uint8_t _readOffset;
 
-   int nextEndOffSet();
-   bool isListEnd(char c);
 
 public:
    uint8_t * _buffer;
@@ -42,8 +41,11 @@ public:
   virtual int read();
   virtual int available();
   virtual void flush();
+  void clear(); // like flush, without filling the buffer with zeros
+  virtual int availableForWrite() { return _len - _endOffset; }
 
   String readString();
+  Slice readList();
   int readLongValues(long values[], int max);
   int readIntValues(int values[], int max);
   int readFloatValues(float values[], int max);
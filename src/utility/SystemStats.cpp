@@ -0,0 +1,104 @@
+/*
+ * ******************************************************************************
+ *  Copyright (c) 2013-2014 CriativaSoft (www.criativasoft.com.br)
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *  Ricardo JL Rufino - Initial API and Implementation
+ * *****************************************************************************
+ */
+
+#include "SystemStats.h"
+
+#if defined(__AVR__)
+
+extern int __heap_start, *__brkval;
+
+#define STACK_PAINT 0xC5
+#define STACK_MARGIN 32 // bytes not painted near heap end and current stack
+
+static uint8_t *heapEnd(){
+	return (__brkval == 0 ? (uint8_t *) &__heap_start : (uint8_t *) __brkval);
+}
+
+void SystemStats::paintStack(){
+	uint8_t top;
+	uint8_t *p = heapEnd() + STACK_MARGIN;
+	while (p < &top - STACK_MARGIN) *p++ = STACK_PAINT;
+}
+
+uint32_t SystemStats::freeMemory(){
+	uint8_t top;
+	return &top - heapEnd();
+}
+
+uint32_t SystemStats::largestFreeBlock(){
+	return freeMemory(); // space between heap and stack (free list is not checked)
+}
+
+uint8_t SystemStats::fragmentation(){
+	return 0;
+}
+
+uint32_t SystemStats::minFreeStack(){
+	uint8_t top;
+	uint8_t *p = heapEnd();
+	while (p < &top && *p != STACK_PAINT) p++; // skip heap margin
+	uint32_t bytes = 0;
+	while (p < &top && *p == STACK_PAINT) { p++; bytes++; }
+	return bytes;
+}
+
+float SystemStats::cpuTemperature(){
+	#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega168__) || defined(__AVR_ATmega168P__)
+		// ADC channel 8 with internal 1.1V reference (see datasheet: Temperature Measurement)
+		ADMUX = _BV(REFS1) | _BV(REFS0) | _BV(MUX3);
+		ADCSRA |= _BV(ADEN);
+		delay(10); // wait for reference
+		ADCSRA |= _BV(ADSC);
+		while (bit_is_set(ADCSRA, ADSC));
+		return (ADCW - 324.31) / 1.22; // analogRead restores ADMUX on next call
+	#else
+		return NAN;
+	#endif
+}
+
+#elif defined(ESP8266)
+
+void SystemStats::paintStack(){
+	// SDK keeps the stack high-water mark
+}
+
+uint32_t SystemStats::freeMemory(){
+	return ESP.getFreeHeap();
+}
+
+uint32_t SystemStats::largestFreeBlock(){
+	return ESP.getMaxFreeBlockSize();
+}
+
+uint8_t SystemStats::fragmentation(){
+	return ESP.getHeapFragmentation();
+}
+
+uint32_t SystemStats::minFreeStack(){
+	return ESP.getFreeContStack();
+}
+
+float SystemStats::cpuTemperature(){
+	return NAN;
+}
+
+#else
+
+void SystemStats::paintStack(){ }
+uint32_t SystemStats::freeMemory(){ return 0; }
+uint32_t SystemStats::largestFreeBlock(){ return 0; }
+uint8_t SystemStats::fragmentation(){ return 0; }
+uint32_t SystemStats::minFreeStack(){ return 0; }
+float SystemStats::cpuTemperature(){ return NAN; }
+
+#endif
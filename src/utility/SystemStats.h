@@ -0,0 +1,45 @@
+/*
+ * ******************************************************************************
+ *  Copyright (c) 2013-2014 CriativaSoft (www.criativasoft.com.br)
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *  Ricardo JL Rufino - Initial API and Implementation
+ * *****************************************************************************
+ */
+
+#ifndef SystemStats_h
+#define SystemStats_h
+
+#include <Arduino.h>
+#include "config.h"
+
+/**
+ * Memory and CPU information of the board, used by MEMORY_REPORT and CPU_TEMPERATURE_REPORT.
+ * Values not available on current platform are 0 (or NAN for temperature).
+ */
+class SystemStats {
+public:
+
+	/** Fill free RAM between heap and stack with a known pattern, so minFreeStack can find how deep the stack went (AVR) */
+	static void paintStack();
+
+	static uint32_t freeMemory();
+
+	/** Largest block that can be allocated */
+	static uint32_t largestFreeBlock();
+
+	/** Heap fragmentation (%) */
+	static uint8_t fragmentation();
+
+	/** Lowest free stack seen (high-water mark), in bytes */
+	static uint32_t minFreeStack();
+
+	/** Internal temperature sensor (Celsius), NAN if not supported */
+	static float cpuTemperature();
+};
+
+#endif
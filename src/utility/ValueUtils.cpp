@@ -0,0 +1,159 @@
+/*
+ * ******************************************************************************
+ *  Copyright (c) 2013-2014 CriativaSoft (www.criativasoft.com.br)
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *  Ricardo JL Rufino - Initial API and Implementation
+ * *****************************************************************************
+ */
+
+#include "ValueUtils.h"
+
+// "00" .. "99": two digits for each division by 100 (half the divisions of one digit at a time)
+static const char DIGIT_PAIRS[200] PROGMEM = {
+	'0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+	'1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+	'2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+	'3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+	'4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+	'5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+	'6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+	'7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+	'8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+	'9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+static const uint32_t POW10[] PROGMEM = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+static inline uint32_t powerOf10(uint8_t exponent){
+	return pgm_read_dword(&POW10[exponent]);
+}
+
+// Digits of 'number', at least 'width' (zeros on left)
+static uint8_t formatUnsigned(char buffer[], uint32_t number, uint8_t width){
+	char digits[10];
+	uint8_t pos = sizeof(digits);
+
+	while(number >= 100){
+		uint8_t pair = (number % 100) * 2;
+		number /= 100;
+		digits[--pos] = pgm_read_byte(&DIGIT_PAIRS[pair + 1]);
+		digits[--pos] = pgm_read_byte(&DIGIT_PAIRS[pair]);
+	}
+
+	if(number >= 10){
+		digits[--pos] = pgm_read_byte(&DIGIT_PAIRS[number * 2 + 1]);
+		digits[--pos] = pgm_read_byte(&DIGIT_PAIRS[number * 2]);
+	}else{
+		digits[--pos] = '0' + number;
+	}
+
+	while(sizeof(digits) - pos < width) digits[--pos] = '0';
+
+	uint8_t length = sizeof(digits) - pos;
+	memcpy(buffer, digits + pos, length);
+	return length;
+}
+
+// Scaled value as integer part, point and 'decimals' digits
+static uint8_t formatScaled(char buffer[], int32_t scaled, uint8_t decimals){
+	uint8_t length = 0;
+	uint32_t number = scaled;
+
+	if(scaled < 0){
+		buffer[length++] = '-';
+		number = -(uint32_t) scaled;
+	}
+
+	if(decimals == 0) return length + formatUnsigned(buffer + length, number, 1);
+
+	length += formatUnsigned(buffer + length, number / powerOf10(decimals), 1);
+	buffer[length++] = '.';
+	length += formatUnsigned(buffer + length, number % powerOf10(decimals), decimals);
+	return length;
+}
+
+uint8_t formatNumber(char buffer[], long number){
+	if(number < 0){
+		buffer[0] = '-';
+		return 1 + formatUnsigned(buffer + 1, -(uint32_t) number, 1);
+	}
+	return formatUnsigned(buffer, number, 1);
+}
+
+#if VALUE_TYPE == VALUE_FIXED
+
+// Q16.16 has about 4 decimal digits of precision
+#define FIXED_DECIMALS 4
+
+uint8_t formatValue(char buffer[], value_t value, uint8_t decimals){
+	if(decimals > FIXED_DECIMALS) decimals = FIXED_DECIMALS;
+	return formatScaled(buffer, valueToScaled(value, powerOf10(decimals)), decimals);
+}
+
+size_t printValue(Print &out, value_t value, uint8_t decimals){
+	char text[VALUE_TEXT_SIZE];
+	return out.write((const uint8_t *) text, formatValue(text, value, decimals));
+}
+
+int32_t valueToScaled(value_t value, int32_t scale){
+	int64_t scaled = (int64_t) value.raw * scale;
+	scaled += (scaled < 0 ? -(Fixed::ONE / 2) : Fixed::ONE / 2);
+	return (int32_t) (scaled / Fixed::ONE);
+}
+
+value_t valueFromScaled(int32_t scaled, int32_t scale){
+	return Fixed::fromRaw((int32_t) (((int64_t) scaled * Fixed::ONE) / scale));
+}
+
+#elif VALUE_TYPE == VALUE_INT32
+
+uint8_t formatValue(char buffer[], value_t value, uint8_t decimals){
+	return formatNumber(buffer, value);
+}
+
+size_t printValue(Print &out, value_t value, uint8_t decimals){
+	char text[VALUE_TEXT_SIZE];
+	return out.write((const uint8_t *) text, formatNumber(text, value));
+}
+
+int32_t valueToScaled(value_t value, int32_t scale){
+	return value * scale;
+}
+
+value_t valueFromScaled(int32_t scaled, int32_t scale){
+	return scaled / scale;
+}
+
+#else
+
+uint8_t formatValue(char buffer[], value_t value, uint8_t decimals){
+	if(decimals >= sizeof(POW10) / sizeof(POW10[0])) return 0;
+
+	value_t scaled = value * powerOf10(decimals);
+	if(!(scaled < 2147483647.0 && scaled > -2147483647.0)) return 0; // too large, NaN or infinite
+
+	return formatScaled(buffer, (int32_t) (scaled < 0 ? scaled - 0.5 : scaled + 0.5), decimals);
+}
+
+size_t printValue(Print &out, value_t value, uint8_t decimals){
+	char text[VALUE_TEXT_SIZE];
+	uint8_t length = formatValue(text, value, decimals);
+	if(length) return out.write((const uint8_t *) text, length);
+	return out.print(value, decimals);
+}
+
+int32_t valueToScaled(value_t value, int32_t scale){
+	value_t scaled = value * scale;
+	return (int32_t) (scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+}
+
+value_t valueFromScaled(int32_t scaled, int32_t scale){
+	return scaled / (value_t) scale;
+}
+
+#endif
@@ -0,0 +1,46 @@
+/*
+ * ******************************************************************************
+ *  Copyright (c) 2013-2014 CriativaSoft (www.criativasoft.com.br)
+ *  All rights reserved. This program and the accompanying materials
+ *  are made available under the terms of the Eclipse Public License v1.0
+ *  which accompanies this distribution, and is available at
+ *  http://www.eclipse.org/legal/epl-v10.html
+ *
+ *  Contributors:
+ *  Ricardo JL Rufino - Initial API and Implementation
+ * *****************************************************************************
+ */
+
+#ifndef ValueUtils_h
+#define ValueUtils_h
+
+#include <Arduino.h>
+#include "config.h"
+
+/*
+ * Operations on value_t that depend on VALUE_TYPE (see config.h).
+ * With VALUE_INT32 and VALUE_FIXED they don't use floating point.
+ */
+
+/** Room needed by formatNumber and formatValue: sign, 10 digits, point and 1 digit more when value < 1 */
+#define VALUE_TEXT_SIZE 14
+
+/** Write number as text in 'buffer' (not terminated). Return the length */
+uint8_t formatNumber(char buffer[], long number);
+
+/**
+ * Write value with 'decimals' as text in 'buffer' (not terminated), using integer operations (scaled value).
+ * Return the length, or 0 if the scaled value doesn't fit in 32 bits (use printValue).
+ */
+uint8_t formatValue(char buffer[], value_t value, uint8_t decimals);
+
+/** Print value with 'decimals' (like Print::print(double, decimals)), integers (VALUE_INT32) are printed without decimals */
+size_t printValue(Print &out, value_t value, uint8_t decimals = 2);
+
+/** Value multiplied by 'scale' and rounded, e.g. fixed point with 2 decimals: valueToScaled(value, 100) */
+int32_t valueToScaled(value_t value, int32_t scale);
+
+/** Value from number multiplied by 'scale' (see valueToScaled) */
+value_t valueFromScaled(int32_t scaled, int32_t scale);
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * Host build of examples/ParserBenchmark: same recorded stream and IR list, parser only
+ * (dispatch needs OpenDeviceClass and devices, measure it on the board).
+ * Times are in ns per command, use the same machine to compare before/after a change.
+ */
+
+#include "TestStreams.h"
+#include <DeviceConnection.h>
+#include <chrono>
+
+#define ROUNDS 20000
+
+// Recorded stream: ON_OFF, ANALOG, PING, USER_COMMAND, unknown device
+static const char RECORDED[] =
+  "/1/1/1/1\r"
+  "/1/2/1/0\r"
+  "/2/3/2/128\r"
+  "/2/4/2/255\r"
+  "/20/5/0\r"
+  "/99/6/bench/3\r"
+  "/1/7/99/1\r";
+
+// IR raw timings (NEC), same list format used by IRDevice
+static const char IR_RAW[] =
+  "/99/8/ir/[8950,4450,600,550,600,1650,600,550,600,1650,600,1650,600,550,600,1650,600,39500]\r";
+
+#define IR_VALUES 18
+
+// Long numbers (like timestamps), where several digits per step pays off
+static const char TIMESTAMPS[] =
+  "/99/9/log/[1700000000,1700000123,1700004567,1700089012,1700123456,1700234567,1700345678,1700456789]\r";
+
+#define TIMESTAMP_VALUES 8
+
+static uint64_t nanos() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void benchParser() {
+	ReplayStream replay(RECORDED);
+	DeviceConnection conn(replay);
+	unsigned long commands = 0;
+
+	uint64_t start = nanos();
+	for (int i = 0; i < ROUNDS; ++i) {
+		replay.rewind();
+		while (replay.available()) {
+			if (conn.checkDataAvalible()) {
+				commands++;
+				conn.flush();
+			}
+		}
+	}
+	uint64_t elapsed = nanos() - start;
+
+	printf("Parser :: cmds: %lu || cmds/s: %.0f || bytes/s: %.0f || ns/cmd: %.1f\n", commands,
+			commands * 1e9 / elapsed, replay.rx * 1e9 / elapsed, (double) elapsed / commands);
+	CHECK(commands == ROUNDS * 7UL);
+}
+
+static void benchArray(const char *title, bool bulk) {
+	ReplayStream replay(IR_RAW);
+	DeviceConnection conn(replay);
+	int values[IR_VALUES];
+	uint64_t spent = 0;
+
+	for (int i = 0; i < ROUNDS; ++i) {
+		replay.rewind();
+		conn.checkDataAvalible();
+		conn.readSlice(); // skip command name
+
+		uint64_t begin = nanos();
+		if (bulk) {
+			conn.readIntValues(values, IR_VALUES);
+		} else {
+			for (int v = 0; v < IR_VALUES; ++v) values[v] = conn.readInt();
+		}
+		spent += nanos() - begin;
+
+		conn.flush();
+	}
+
+	printf("%s :: ns/list: %.1f || ns/value: %.1f\n", title, (double) spent / ROUNDS, (double) spent / (ROUNDS * IR_VALUES));
+	CHECK(values[0] == 8950 && values[IR_VALUES - 1] == 39500);
+}
+
+static void benchLongArray() {
+	ReplayStream replay(TIMESTAMPS);
+	DeviceConnection conn(replay);
+	long values[TIMESTAMP_VALUES];
+	uint64_t spent = 0;
+
+	for (int i = 0; i < ROUNDS; ++i) {
+		replay.rewind();
+		conn.checkDataAvalible();
+		conn.readSlice(); // skip command name
+
+		uint64_t begin = nanos();
+		conn.readLongValues(values, TIMESTAMP_VALUES);
+		spent += nanos() - begin;
+
+		conn.flush();
+	}
+
+	printf("Long array (readLongValues) :: ns/list: %.1f || ns/value: %.1f\n", (double) spent / ROUNDS, (double) spent / (ROUNDS * TIMESTAMP_VALUES));
+	CHECK(values[0] == 1700000000L && values[TIMESTAMP_VALUES - 1] == 1700456789L);
+}
+
+// Digit decoder alone: values of a list (without '[', ']' and '\r'), best of 5 runs
+static void benchDecode(const char *title, const char *command, int count) {
+	const char *start = strchr(command, '[') + 1;
+	Slice list = { start, (uint16_t) (strchr(start, ']') - start) };
+	long values[IR_VALUES];
+	double best = 1e9;
+
+	for (int run = 0; run < 5; ++run) {
+		uint64_t begin = nanos();
+		for (int i = 0; i < ROUNDS * 10; ++i) {
+			CHECK(list.toArray(values, count) == count);
+		}
+		double ns = (double) (nanos() - begin) / (ROUNDS * 10.0 * count);
+		if (ns < best) best = ns;
+	}
+
+	printf("%s :: ns/value: %.2f\n", title, best);
+}
+
+int main() {
+	printf("ENABLE_SWAR_DECODER: %d\n", ENABLE_SWAR_DECODER);
+	benchParser();
+	benchArray("Array (readIntValues)", true);
+	benchArray("Array (readInt)", false);
+	benchLongArray();
+	benchDecode("Decode IR list", IR_RAW, IR_VALUES);
+	benchDecode("Decode timestamps", TIMESTAMPS, TIMESTAMP_VALUES);
+	return report("ParserBench");
+}
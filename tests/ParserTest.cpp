@@ -0,0 +1,126 @@
+/*
+ * DeviceConnection parser: text commands, binary frames, lists and tokens
+ */
+
+#include "TestStreams.h"
+#include <DeviceConnection.h>
+
+static Command received[8];
+static int receivedCount = 0;
+
+static void onCommand(Command cmd) {
+	if (receivedCount < 8) received[receivedCount] = cmd;
+	receivedCount++;
+}
+
+static int receiveAll(DeviceConnection &conn) {
+	int count = 0;
+	while (conn.conn->available()) {
+		if (conn.checkDataAvalible()) {
+			count++;
+			conn.flush();
+		}
+	}
+	return count;
+}
+
+static void testCommands() {
+	ReplayStream stream("/1/1/1/1\r/2/3/2/128\r/20/5/0\r");
+	DeviceConnection conn(stream);
+	receivedCount = 0;
+	conn.setDefaultListener(onCommand);
+
+	CHECK(receiveAll(conn) == 3);
+	CHECK(receivedCount == 3);
+	CHECK(received[0].type == 1 && received[0].id == 1 && received[0].deviceID == 1 && received[0].value == 1);
+	CHECK(received[1].type == 2 && received[1].id == 3 && received[1].deviceID == 2 && received[1].value == 128);
+	CHECK(received[2].type == 20 && received[2].id == 5);
+	CHECK(conn.rxErrors == 0);
+}
+
+static void testExtraData() {
+	ReplayStream stream("/99/8/ir/[8950,4450,600,39500]\r");
+	DeviceConnection conn(stream);
+
+	CHECK(conn.checkDataAvalible());
+
+	Slice name = conn.readSlice();
+	CHECK(name.equals("ir", 2));
+	CHECK(DeviceConnection::hash(name) == DeviceConnection::hash("ir"));
+
+	int values[8];
+	CHECK(conn.readIntValues(values, 8) == 4);
+	CHECK(values[0] == 8950 && values[1] == 4450 && values[2] == 600 && values[3] == 39500);
+	CHECK(!conn.hasNextNumber());
+}
+
+static void testReadInt() {
+	ReplayStream stream("/99/1/cmd/12;-34;567890\r");
+	DeviceConnection conn(stream);
+
+	CHECK(conn.checkDataAvalible());
+	conn.readSlice();
+	CHECK(conn.readInt() == 12);
+	CHECK(conn.readInt() == -34);
+	CHECK(conn.readLong() == 567890);
+}
+
+static void testOverflow() {
+	char text[DATA_BUFFER + 32];
+	memset(text, '1', sizeof(text));
+	memcpy(text, "/99/1/", 6);
+	text[sizeof(text) - 2] = '\r';
+	text[sizeof(text) - 1] = 0;
+
+	ReplayStream stream(text);
+	DeviceConnection conn(stream);
+	receivedCount = 0;
+	conn.setDefaultListener(onCommand);
+
+	receiveAll(conn);
+	CHECK(conn.rxOverflows > 0); // reported for each byte that does not fit
+
+	// next command is still received
+	stream.load("/1/2/1/0\r");
+	CHECK(receiveAll(conn) == 1);
+	CHECK(received[receivedCount - 1].id == 2);
+}
+
+static void testFrameRoundTrip() {
+	ReplayStream out;
+	DeviceConnection sender(out);
+	if (!sender.acceptFrameFormat(FrameFormat::BINARY)) return;
+	sender.setFrameFormat(FrameFormat::BINARY);
+
+	Command cmd;
+	cmd.type = CommandType::ANALOG;
+	cmd.id = 7;
+	cmd.deviceID = 3;
+	cmd.value = 1000;
+	sender.send(cmd, true);
+	sender.flushTx();
+	sender.drainTx();
+
+	static char frame[64];
+	memcpy(frame, out.out, out.tx);
+	frame[out.tx] = 0;
+
+	ReplayStream in;
+	in.data = frame;
+	in.len = out.tx;
+	DeviceConnection receiver(in);
+	receivedCount = 0;
+	receiver.setDefaultListener(onCommand);
+
+	CHECK(receiveAll(receiver) == 1);
+	CHECK(received[0].type == CommandType::ANALOG && received[0].id == 7 && received[0].deviceID == 3 && received[0].value == 1000);
+}
+
+int main() {
+	testCommands();
+	testExtraData();
+	testReadInt();
+	testOverflow();
+	testFrameRoundTrip();
+	return report("ParserTest");
+}
@@ -0,0 +1,60 @@
+/*
+ * Slice: numbers of every length and separator, compared with strtol (covers the SWAR digit path)
+ */
+
+#include "TestStreams.h"
+#include <Slice.h>
+
+static void testLists() {
+	char text[256];
+	long expected[32];
+
+	srand(1);
+	for (int round = 0; round < 20000; round++) {
+		int count = 1 + rand() % 16;
+		int length = 0;
+
+		for (int i = 0; i < count; i++) {
+			int digits = 1 + rand() % 9; // fits 32-bit long
+			int start = length;
+			if (rand() % 4 == 0) text[length++] = '-';
+			for (int d = 0; d < digits; d++) text[length++] = '0' + rand() % 10;
+			text[length] = 0;
+			expected[i] = strtol(text + start, NULL, 10);
+
+			const char separators[] = ",;] x";
+			text[length++] = separators[rand() % (sizeof(separators) - 1)];
+		}
+		text[length] = 0;
+
+		Slice slice = { text, (uint16_t) length };
+		long value;
+		int n = 0;
+		while (slice.nextInt(value)) {
+			if (n < count) CHECK(value == expected[n]);
+			n++;
+		}
+		CHECK(n == count);
+	}
+}
+
+static void testSlice() {
+	const char text[] = "12345678901;x";
+	Slice slice = { text, 5 }; // value ends with the slice, not with the buffer
+	CHECK(slice.toInt() == 12345);
+
+	Slice empty = { "", 0 };
+	long value;
+	CHECK(!empty.nextInt(value));
+
+	Slice name = { "bench/3", 5 };
+	CHECK(name.equals("bench"));
+	CHECK(!name.equals("benc"));
+	CHECK(name.equals("benchmark", 5));
+}
+
+int main() {
+	testLists();
+	testSlice();
+	return report("SliceTest");
+}
@@ -0,0 +1,108 @@
+/*
+ * StateLog: empty log, save/load and writes interrupted by a reset
+ */
+
+#include "TestStreams.h"
+#include <StateLog.h>
+
+#define LOG_START 16
+#define LOG_SIZE (12 * StateLog::RECORD_SIZE)
+
+/**
+ * StateLog over a RAM buffer, writes fail after 'writesLeft' bytes (reset while writing)
+ */
+class MemoryLog : public StateLog {
+public:
+	MemoryLog(uint8_t *memory, uint16_t size) : StateLog(LOG_START, size), memory(memory), writesLeft(-1), writes(0) {}
+
+	uint8_t *memory;
+	long writesLeft; // -1 is unlimited
+	long writes;
+
+protected:
+	uint8_t read(uint16_t address) { return memory[address]; }
+	void write(uint16_t address, uint8_t value) {
+		if (writesLeft == 0) return;
+		if (writesLeft > 0) writesLeft--;
+		writes++;
+		memory[address] = value;
+	}
+};
+
+static uint8_t memory[LOG_START + LOG_SIZE + 16];
+
+static void testNoSlots() {
+	memset(memory, 0xFF, sizeof(memory));
+	MemoryLog log(memory, 0); // STATE_LOG_SIZE 0
+
+	uint8_t state[DEVICES_STATE_SIZE] = {0};
+	uint8_t value = 1;
+
+	log.load(state, sizeof(state));
+	CHECK(log.capacity() == 0);
+	CHECK(!log.append(0, &value, 1));
+	log.clear();
+	CHECK(log.writes == 0);
+}
+
+static void testSaveLoad() {
+	memset(memory, 0xFF, sizeof(memory));
+	MemoryLog log(memory, LOG_SIZE);
+	log.load(NULL, 0);
+
+	// more changes than slots, the ring wraps around
+	for (uint8_t i = 0; i < 50; i++) {
+		uint8_t value[2] = { i, (uint8_t) (i * 3) };
+		CHECK(log.append((i % 4) * 2, value, 2));
+	}
+
+	uint8_t state[DEVICES_STATE_SIZE] = {0};
+	MemoryLog loaded(memory, LOG_SIZE);
+	loaded.load(state, sizeof(state));
+
+	for (uint8_t offset = 0; offset < 4; offset++) {
+		uint8_t last = 49 - (49 - offset) % 4; // last i with i % 4 == offset
+		CHECK(state[offset * 2] == last && state[offset * 2 + 1] == (uint8_t) (last * 3));
+	}
+	CHECK(loaded.sequence() == log.sequence());
+}
+
+// A reset at any byte of a save loses at most the value being saved
+static void testInterrupted() {
+	const uint8_t offsets = 6;
+
+	for (long stop = 0; stop < 40 * StateLog::RECORD_SIZE; stop++) {
+		memset(memory, 0xFF, sizeof(memory));
+		MemoryLog log(memory, LOG_SIZE);
+		log.load(NULL, 0);
+
+		uint8_t saved[offsets] = {0};
+		log.writesLeft = stop;
+
+		uint8_t writing = 0xFF;
+		for (uint8_t i = 0; i < 40; i++) {
+			uint8_t offset = i % offsets;
+			uint8_t value = i + 1;
+			writing = offset;
+			log.append(offset, &value, 1);
+			if (log.writesLeft == 0) break;
+			saved[offset] = value;
+			writing = 0xFF;
+		}
+
+		uint8_t state[DEVICES_STATE_SIZE] = {0};
+		MemoryLog loaded(memory, LOG_SIZE);
+		loaded.load(state, sizeof(state));
+
+		for (uint8_t offset = 0; offset < offsets; offset++) {
+			if (offset != writing) CHECK(state[offset] == saved[offset]);
+		}
+	}
+}
+
+int main() {
+	testNoSlots();
+	testSaveLoad();
+	testInterrupted();
+	return report("StateLogTest");
+}
@@ -0,0 +1,67 @@
+/*
+ * Streams and checks shared by host tests and benchmarks (see Makefile)
+ */
+
+#ifndef TestStreams_h
+#define TestStreams_h
+
+#include <Arduino.h>
+#include <stdio.h>
+
+static int failures = 0;
+
+#define CHECK(expr) do { if (!(expr)) { failures++; printf("%s:%d: FAIL: %s\n", __FILE__, __LINE__, #expr); } } while (0)
+
+/**
+ * Stream that replays a buffer and keeps (up to 'capacity') everything written.
+ * 'room' is what availableForWrite reports: -1 keeps Print default (0 = unknown, like WiFiClient).
+ */
+class ReplayStream : public Stream {
+public:
+	ReplayStream(const char *data = "") : data(data), len(strlen(data)), pos(0), rx(0), tx(0), room(-1), writes(0) {}
+
+	int available() { return len - pos; }
+	int peek() { return (pos < len ? data[pos] : -1); }
+	int read() {
+		if (pos >= len) return -1;
+		rx++;
+		return data[pos++];
+	}
+
+	size_t write(uint8_t b) { return write(&b, 1); }
+	size_t write(const uint8_t *buffer, size_t size) {
+		writes++;
+		if (room >= 0 && (int) size > room) size = room;
+		for (size_t i = 0; i < size; i++) {
+			if (tx < sizeof(out) - 1) out[tx] = buffer[i];
+			tx++;
+		}
+		out[tx < sizeof(out) ? tx : sizeof(out) - 1] = 0;
+		if (room >= 0) room -= size;
+		return size;
+	}
+
+	int availableForWrite() { return (room >= 0 ? room : Print::availableForWrite()); }
+
+	void load(const char *text) { data = text; len = strlen(text); pos = 0; }
+	void rewind() { pos = 0; }
+	void clearOutput() { tx = 0; writes = 0; out[0] = 0; }
+
+	const char *data;
+	size_t len;
+	size_t pos;
+	unsigned long rx;
+	unsigned long tx;
+	int room;
+	unsigned long writes; // calls to write
+	char out[512];
+
+	using Print::write;
+};
+
+static inline int report(const char *name) {
+	printf("%s: %s\n", name, (failures ? "FAIL" : "PASS"));
+	return failures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ * Send queue (TX_QUEUE): streams with and without availableForWrite
+ */
+
+#include "TestStreams.h"
+#include <DeviceConnection.h>
+
+/**
+ * Counts writes that don't end a command, a MQTTClient would keep them in its buffer
+ */
+class CommandStream : public ReplayStream {
+public:
+	CommandStream() : partial(0) {}
+
+	size_t write(const uint8_t *buffer, size_t size) {
+		size_t n = ReplayStream::write(buffer, size);
+		if (n == 0 || buffer[n - 1] != Command::ACK_BIT) partial++;
+		return n;
+	}
+
+	unsigned long partial;
+
+	using ReplayStream::write;
+};
+
+static Command value(uint8_t id, long value) {
+	Command cmd;
+	cmd.type = CommandType::NUMERIC;
+	cmd.id = 0;
+	cmd.deviceID = id;
+	cmd.value = value;
+	return cmd;
+}
+
+// Like WiFiClient or MQTTClient: availableForWrite is not implemented (0)
+static void testRoomUnknown() {
+	CommandStream stream;
+	DeviceConnection conn(stream);
+
+	conn.send(value(1, 123456), true);
+	conn.send(value(2, -42), true);
+	conn.send(value(3, 7), true);
+
+	CHECK(stream.writes == 3);
+	CHECK(stream.partial == 0);
+	CHECK(conn.txQueued() == 0);
+	CHECK(strcmp(stream.out, "/3/0/1/123456\r/3/0/2/-42\r/3/0/3/7\r") == 0);
+
+	// corked commands are written together
+	stream.clearOutput();
+	conn.cork();
+	for (uint8_t i = 1; i <= 5; i++) conn.send(value(i, i * 1000), true);
+	conn.uncork();
+
+	CHECK(stream.partial == 0);
+	CHECK(conn.txQueued() == 0);
+	CHECK(stream.tx == 5 * strlen("/3/0/1/1000\r"));
+}
+
+// Like HardwareSerial: only what fits is written, the rest waits in the queue
+static void testRoomKnown() {
+#if TX_QUEUE > 0
+	CommandStream stream;
+	DeviceConnection conn(stream);
+	conn.txRoomKnown = true;
+
+	stream.room = 5;
+	conn.send(value(1, 123456), true);
+
+	CHECK(stream.tx == 5);
+	CHECK(conn.txQueued() == strlen("/3/0/1/123456\r") - 5);
+
+	conn.drainTx(); // still full
+	CHECK(stream.tx == 5);
+
+	stream.room = 64;
+	conn.drainTx();
+	CHECK(conn.txQueued() == 0);
+	CHECK(strcmp(stream.out, "/3/0/1/123456\r") == 0);
+#endif
+}
+
+int main() {
+	testRoomUnknown();
+	testRoomKnown();
+	return report("TxQueueTest");
+}
@@ -0,0 +1,56 @@
+/*
+ * Minimal Arduino core for host builds (see Arduino.h)
+ */
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+
+HostSerial Serial;
+EEPROMClass EEPROM;
+
+static const std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count();
+}
+
+unsigned long micros() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count();
+}
+
+void delay(unsigned long ms) {
+	std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+	size_t n = 0;
+	while (size--) n += write(*buffer++);
+	return n;
+}
+
+size_t Print::print(long n, int base) {
+	char text[24];
+	if (base == HEX) snprintf(text, sizeof(text), "%lx", n);
+	else snprintf(text, sizeof(text), "%ld", n);
+	return write(text);
+}
+
+size_t Print::print(unsigned long n, int base) {
+	char text[24];
+	if (base == HEX) snprintf(text, sizeof(text), "%lx", n);
+	else snprintf(text, sizeof(text), "%lu", n);
+	return write(text);
+}
+
+size_t Print::print(double n, int digits) {
+	char text[40];
+	snprintf(text, sizeof(text), "%.*f", digits, n);
+	return write(text);
+}
+
+size_t HostSerial::write(uint8_t b) {
+	return fputc(b, stdout) == EOF ? 0 : 1;
+}
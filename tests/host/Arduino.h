@@ -0,0 +1,100 @@
+/*
+ * Minimal Arduino core for host (PC) builds of the protocol code, used by tests and benchmarks in test/.
+ * Only what DeviceConnection, Slice, ValueUtils and StateLog need.
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define ARDUINO 100
+
+#define HIGH 1
+#define LOW 0
+
+#define DEC 10
+#define HEX 16
+
+#define PROGMEM
+#define F(str) str
+#define pgm_read_byte(address) (*(const uint8_t *) (address))
+#define pgm_read_dword(address) (*(const uint32_t *) (address))
+#define strlen_P strlen
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+class String {
+public:
+	String() {}
+	String(const char *str) : s(str) {}
+	String& operator+=(char c) { s += c; return *this; }
+	const char *c_str() const { return s.c_str(); }
+	unsigned int length() const { return s.length(); }
+	bool equals(const char *str) const { return s == str; }
+private:
+	std::string s;
+};
+
+class Print {
+public:
+	virtual ~Print() {}
+
+	virtual size_t write(uint8_t) = 0;
+	virtual size_t write(const uint8_t *buffer, size_t size);
+	size_t write(const char *str) { return write((const uint8_t *) str, strlen(str)); }
+
+	/** Streams that don't know their free space return 0 (as in Arduino core) */
+	virtual int availableForWrite() { return 0; }
+	virtual void flush() {}
+
+	size_t print(const char *str) { return write(str); }
+	size_t print(const String &str) { return write(str.c_str()); }
+	size_t print(char c) { return write((uint8_t) c); }
+	size_t print(unsigned char n, int base = DEC) { return print((unsigned long) n, base); }
+	size_t print(int n, int base = DEC) { return print((long) n, base); }
+	size_t print(unsigned int n, int base = DEC) { return print((unsigned long) n, base); }
+	size_t print(long n, int base = DEC);
+	size_t print(unsigned long n, int base = DEC);
+	size_t print(double n, int digits = 2);
+
+	size_t println() { return write("\r\n"); }
+	template <class T> size_t println(T value) { size_t n = print(value); return n + println(); }
+};
+
+class Stream : public Print {
+public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+
+	void setTimeout(unsigned long timeout) { (void) timeout; }
+};
+
+/** Serial writes to stdout, nothing is received */
+class HostSerial : public Stream {
+public:
+	void begin(unsigned long baud) { (void) baud; }
+	int available() { return 0; }
+	int read() { return -1; }
+	int peek() { return -1; }
+	size_t write(uint8_t b);
+	using Print::write;
+};
+
+extern HostSerial Serial;
+
+#endif
@@ -0,0 +1,26 @@
+/*
+ * EEPROM in RAM for host builds (see Arduino.h)
+ */
+
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include <Arduino.h>
+
+#define HOST_EEPROM_SIZE 4096
+
+class EEPROMClass {
+public:
+	uint8_t read(int address) { return data[address]; }
+	void write(int address, uint8_t value) { data[address] = value; writes++; }
+
+	template <class T> T& get(int address, T &value) { memcpy(&value, &data[address], sizeof(T)); return value; }
+	template <class T> const T& put(int address, const T &value) { memcpy(&data[address], &value, sizeof(T)); return value; }
+
+	uint8_t data[HOST_EEPROM_SIZE];
+	unsigned long writes;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif